@@ -0,0 +1,166 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  AdaptiveGrid Class.
+  Curvature driven sampling of the mode factors.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "adaptive_grid.h"
+#include <cmath>
+#include <functional>
+#include "bessel.h"
+#include "bessel_zeros.h"
+
+const double AdaptiveGrid::defaultTolerance = 4e-3;
+const int AdaptiveGrid::minimumSegments = 8;
+const int AdaptiveGrid::maximumCount = 4096;
+const int AdaptiveGrid::pilotCells = 32;
+
+namespace {
+
+// |f''| at count points.
+typedef std::function<void(const double* x, double* out, int count)>
+    Curvature;
+
+// Places points on [breakpoints.first(), breakpoints.last()] so that every
+// breakpoint is a point and the density follows the local curvature, or
+// 1 / maxStep where that is higher. The curvature of each pilot cell is
+// the largest seen at the ends of the cell and of its neighbours, which
+// covers peaks between pilot points. When the points would exceed
+// AdaptiveGrid::maximumCount every density is scaled down alike. Every
+// segment takes at least one step, so past maximumCount / 2 segments
+// breakpoints are dropped evenly, keeping both ends, to leave room for
+// the points between them.
+QVector<float> distribute(QVector<double> breakpoints, Curvature curvature,
+                          double tolerance, double maxStep) {
+  const int cells = AdaptiveGrid::pilotCells;
+  const int limit = AdaptiveGrid::maximumCount / 2;
+  if (breakpoints.size() - 1 > limit) {
+    QVector<double> kept(limit + 1);
+    const double stride = double(breakpoints.size() - 1) / limit;
+    for (int i(0); i <= limit; i++) kept[i] = breakpoints[int(i * stride)];
+    kept[limit] = breakpoints.last();
+    breakpoints = kept;
+  }
+  const int segments = breakpoints.size() - 1;
+  QVector<double> pilot(segments * (cells + 1));
+  for (int s(0); s < segments; s++) {
+    const double h = (breakpoints[s + 1] - breakpoints[s]) / cells;
+    for (int i(0); i <= cells; i++)
+      pilot[s * (cells + 1) + i] = breakpoints[s] + i * h;
+  }
+  QVector<double> bend(pilot.size());
+  curvature(pilot.constData(), bend.data(), pilot.size());
+
+  QVector<double> density(segments * cells);
+  QVector<double> weight(segments, 0.0);
+  double total = 0.0;
+  for (int s(0); s < segments; s++) {
+    const double h = (breakpoints[s + 1] - breakpoints[s]) / cells;
+    const double* b = bend.constData() + s * (cells + 1);
+    for (int i(0); i < cells; i++) {
+      double peak = 0.0;
+      for (int j = qMax(0, i - 1); j <= qMin(cells, i + 2); j++)
+        peak = qMax(peak, std::fabs(b[j]));
+      double d = qMax(std::sqrt(peak / (8 * tolerance)), 1.0 / maxStep);
+      density[s * cells + i] = d;
+      weight[s] += d * h;
+    }
+    total += weight[s];
+  }
+  const double scale =
+      qMin(1.0, double(AdaptiveGrid::maximumCount - 1 - segments) / total);
+
+  QVector<float> points;
+  points.append(float(breakpoints[0]));
+  for (int s(0); s < segments; s++) {
+    const double h = (breakpoints[s + 1] - breakpoints[s]) / cells;
+    const double* d = density.constData() + s * cells;
+    const int steps = qMax(1, int(std::ceil(weight[s] * scale)));
+    // Invert the piecewise linear cumulative density.
+    int cell = 0;
+    double below = 0.0;
+    for (int k(1); k < steps; k++) {
+      const double target = weight[s] * k / steps;
+      while (cell < cells - 1 && below + d[cell] * h < target)
+        below += d[cell++] * h;
+      points.append(float(breakpoints[s] + cell * h +
+                          qMin(h, (target - below) / d[cell])));
+    }
+    points.append(float(breakpoints[s + 1]));
+  }
+  return points;
+}
+
+// J_{-p} = (-1)^p J_p.
+void besselValues(int n, const double* x, double* out, int count) {
+  bessel::cyl_bessel_j(std::abs(n), x, out, count);
+  if (n < 0 && (n & 1))
+    for (int i(0); i < count; i++) out[i] = -out[i];
+}
+
+}  // namespace
+
+// The nodal circles are r_i = radius j_{n,i} / j_{n,m}, i < m, and
+// d^2/dr^2 J_n(k r) = k^2 (J_{n-2} - 2 J_n + J_{n+2}) / 4, which has no
+// singularity at the centre.
+QVector<float> AdaptiveGrid::radii(int bessel_order_n, int root_order_m,
+                                   float radius, double tolerance) {
+  BesselZeros& zeros = BesselZeros::instance();
+  const double bessel_root = zeros.zero(bessel_order_n, root_order_m);
+  QVector<double> breakpoints;
+  breakpoints.append(0.0);
+  for (int i(1); i < root_order_m; i++)
+    breakpoints.append(radius * zeros.zero(bessel_order_n, i) / bessel_root);
+  breakpoints.append(radius);
+  const double k = bessel_root / radius;
+  auto curvature = [&](const double* r, double* out, int count) {
+    QVector<double> x(count);
+    QVector<double> lower(count);
+    QVector<double> upper(count);
+    for (int i(0); i < count; i++) x[i] = k * r[i];
+    besselValues(bessel_order_n, x.constData(), out, count);
+    besselValues(bessel_order_n - 2, x.constData(), lower.data(), count);
+    besselValues(bessel_order_n + 2, x.constData(), upper.data(), count);
+    for (int i(0); i < count; i++)
+      out[i] = k * k * (lower[i] - 2 * out[i] + upper[i]) / 4;
+  };
+  return distribute(breakpoints, curvature, tolerance,
+                    radius / minimumSegments);
+}
+
+// cos(n theta) vanishes at theta = (2 i + 1) pi / (2 n).
+QVector<float> AdaptiveGrid::thetas(float bessel_order_n, double tolerance) {
+  const double n = std::fabs(bessel_order_n);
+  QVector<double> breakpoints;
+  breakpoints.append(0.0);
+  if (n > 0.0)
+    for (int i(0); (2 * i + 1) * M_PI / (2 * n) < 2 * M_PI; i++)
+      breakpoints.append((2 * i + 1) * M_PI / (2 * n));
+  breakpoints.append(2 * M_PI);
+  auto curvature = [n](const double* theta, double* out, int count) {
+    for (int i(0); i < count; i++) out[i] = n * n * std::cos(n * theta[i]);
+  };
+  return distribute(
+      breakpoints, curvature, tolerance,
+      qMin(std::sqrt(8 * tolerance), 2 * M_PI / minimumSegments));
+}
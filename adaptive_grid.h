@@ -0,0 +1,56 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  AdaptiveGrid Class.
+  Curvature driven sampling of the mode factors.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef ADAPTIVEGRID_H
+#define ADAPTIVEGRID_H
+
+#include <QtCore/QVector>
+
+// Non-uniform sample positions for one mode, chosen from the mode itself.
+// Piecewise linear interpolation over a step h errs by at most
+// h^2 max|f''| / 8, so points are spread with a density proportional to
+// sqrt(|f''| / (8 tolerance)): dense where the factor bends, sparse where
+// it is straight or flat. The nodal circles and diameters are always
+// samples, so nodal lines are exact and every step lies on one side of a
+// node. Rows and columns stay ascending, which is all a surface proxy
+// needs to render the grid.
+class AdaptiveGrid {
+ public:
+  const static double defaultTolerance;
+  const static int minimumSegments;
+  const static int maximumCount;
+  const static int pilotCells;
+
+  // Radii in [0, radius] for J_n(j_{n,m} r / radius).
+  static QVector<float> radii(int bessel_order_n, int root_order_m,
+                              float radius, double tolerance);
+  // Angles in [0, 2 pi] for cos(n theta); the step also stays below
+  // sqrt(8 tolerance), so the rim polygon is within tolerance of the
+  // circle in units of the radius.
+  static QVector<float> thetas(float bessel_order_n, double tolerance);
+};
+
+#endif
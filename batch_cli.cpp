@@ -0,0 +1,171 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  Headless batch mode.
+  Command line front end of ModeBatch.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "batch_cli.h"
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QStringList>
+#include <cstring>
+#include "bessel_zeros.h"
+#include "mode_batch.h"
+
+namespace {
+
+// Parses "a", "a:b", "a:b:step" (inclusive) or comma separated lists of
+// those into values; returns false on malformed input.
+template <typename T>
+bool parseValues(const QString& text, QVector<T>* values) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+  const Qt::SplitBehavior skipEmpty = Qt::SkipEmptyParts;
+#else
+  const QString::SplitBehavior skipEmpty = QString::SkipEmptyParts;
+#endif
+  for (const QString& part : text.split(',', skipEmpty)) {
+    QStringList bounds = part.split(':');
+    if (bounds.size() > 3) return false;
+    bool ok[3] = {true, true, true};
+    double first = bounds[0].toDouble(&ok[0]);
+    double last = bounds.size() > 1 ? bounds[1].toDouble(&ok[1]) : first;
+    double step = bounds.size() > 2 ? bounds[2].toDouble(&ok[2]) : 1.0;
+    if (!ok[0] || !ok[1] || !ok[2] || step <= 0.0 || last < first)
+      return false;
+    for (int i(0); first + i * step <= last + 1e-9 * step; i++)
+      values->append(T(first + i * step));
+  }
+  return !values->isEmpty();
+}
+
+}  // namespace
+
+namespace batch_cli {
+
+bool isRequested(int argc, char** argv) {
+  for (int i(1); i < argc; i++)
+    if (!std::strcmp(argv[i], "--batch")) return true;
+  return false;
+}
+
+int run(QCoreApplication& app) {
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "Generates normal modes headless and streams them into one file.\n"
+      "Values take a number, a range first:last[:step] or a comma "
+      "separated list of those.");
+  parser.addHelpOption();
+  QCommandLineOption batchOption("batch", "Run headless.");
+  QCommandLineOption ordersOption("orders", "Bessel orders n.", "values",
+                                  "0");
+  QCommandLineOption rootsOption("roots", "Root orders m.", "values", "1");
+  QCommandLineOption samplesOption("samples", "Samples per axis.", "values",
+                                   "200");
+  QCommandLineOption radiusOption("radius", "Membrane radius.", "values",
+                                  "20");
+  QCommandLineOption waveSpeedOption("wave-speed", "Wave speed.", "values",
+                                     "200");
+  QCommandLineOption threadsOption("threads",
+                                   "Worker threads, 0 for one per core.",
+                                   "count", "0");
+  QCommandLineOption outputOption(QStringList() << "o" << "output",
+                                  "Output file.", "file");
+  parser.addOption(batchOption);
+  parser.addOption(ordersOption);
+  parser.addOption(rootsOption);
+  parser.addOption(samplesOption);
+  parser.addOption(radiusOption);
+  parser.addOption(waveSpeedOption);
+  parser.addOption(threadsOption);
+  parser.addOption(outputOption);
+  parser.process(app);
+
+  QVector<float> orders;
+  QVector<int> roots;
+  QVector<int> sampleCounts;
+  QVector<float> radii;
+  QVector<float> waveSpeeds;
+  if (!parseValues(parser.value(ordersOption), &orders) ||
+      !parseValues(parser.value(rootsOption), &roots) ||
+      !parseValues(parser.value(samplesOption), &sampleCounts) ||
+      !parseValues(parser.value(radiusOption), &radii) ||
+      !parseValues(parser.value(waveSpeedOption), &waveSpeeds)) {
+    qCritical("Malformed value list.");
+    return 1;
+  }
+  for (float n : orders)
+    if (n < 0 || n > BesselZeros::maxOrder || n != int(n)) {
+      qCritical("Bessel orders must be integers in [0, %d].",
+                BesselZeros::maxOrder);
+      return 1;
+    }
+  for (int m : roots)
+    if (m < 1 || m > BesselZeros::maxRoot) {
+      qCritical("Root orders must be in [1, %d].", BesselZeros::maxRoot);
+      return 1;
+    }
+  for (int samples : sampleCounts)
+    if (samples < 2) {
+      qCritical("Sample counts must be at least 2.");
+      return 1;
+    }
+  for (float radius : radii)
+    if (radius <= 0) {
+      qCritical("Radii must be positive.");
+      return 1;
+    }
+  for (float wave_speed : waveSpeeds)
+    if (wave_speed <= 0) {
+      qCritical("Wave speeds must be positive.");
+      return 1;
+    }
+  if (!parser.isSet(outputOption)) {
+    qCritical("No output file given.");
+    return 1;
+  }
+
+  QVector<ModeBatch::Grid> grids;
+  for (int samples : sampleCounts)
+    for (float radius : radii)
+      for (float wave_speed : waveSpeeds)
+        grids.append(ModeBatch::Grid{samples, radius, wave_speed});
+
+  ModeBatch batch;
+  batch.setOrders(orders);
+  batch.setRoots(roots);
+  batch.setGrids(grids);
+  batch.setThreadCount(parser.value(threadsOption).toInt());
+  qInfo("Generating %d modes into %s", batch.modeCount(),
+        qPrintable(parser.value(outputOption)));
+  int reported = -1;
+  bool ok = batch.write(parser.value(outputOption), [&reported](int percent) {
+    if (percent / 10 != reported / 10) qInfo("%d%%", percent);
+    reported = percent;
+    return true;
+  });
+  if (!ok) {
+    qCritical("Cannot write %s", qPrintable(parser.value(outputOption)));
+    return 1;
+  }
+  return 0;
+}
+}
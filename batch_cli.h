@@ -0,0 +1,39 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  Headless batch mode.
+  Command line front end of ModeBatch.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef BATCHCLI_H
+#define BATCHCLI_H
+
+#include <QtCore/QCoreApplication>
+
+// Headless batch mode: circular_membrane --batch [options]. Generates mode
+// fields with ModeBatch without creating any window or OpenGL context.
+namespace batch_cli {
+bool isRequested(int argc, char** argv);
+int run(QCoreApplication& app);
+}
+
+#endif
@@ -0,0 +1,101 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  Heap allocation counter and peak RSS for the benchmarks.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "alloc_counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+namespace {
+std::atomic<qint64> counter{0};
+}
+
+#if defined(__GLIBC__)
+// glibc: interpose the malloc family itself, which also sees Qt containers
+// (QArrayData allocates with malloc) and operator new, which calls malloc.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+
+void* malloc(size_t size) {
+  ++counter;
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+  ++counter;
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+  ++counter;
+  return __libc_realloc(pointer, size);
+}
+}
+#else
+// Elsewhere only operator new is seen; Qt container storage is missed.
+void* operator new(std::size_t size) {
+  ++counter;
+  if (void* pointer = std::malloc(size ? size : 1)) return pointer;
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  std::free(pointer);
+}
+#endif
+
+namespace alloc_counter {
+
+qint64 allocations() {
+  return counter.load(std::memory_order_relaxed);
+}
+
+qint64 peakResidentBytes() {
+#if defined(Q_OS_UNIX)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(Q_OS_MACOS)
+  return qint64(usage.ru_maxrss);
+#else
+  return qint64(usage.ru_maxrss) * 1024;
+#endif
+#else
+  return 0;
+#endif
+}
+}
@@ -0,0 +1,328 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  Benchmark Class.
+  Headless timing of the computational hot paths.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "benchmark.h"
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QThread>
+#include <QtDataVisualization/QSurfaceDataProxy>
+#include <boost/math/special_functions/bessel.hpp>
+#include <cmath>
+#include "alloc_counter.h"
+#include "bessel.h"
+#include "drum_synth.h"
+#include "fdtd_solver.h"
+#include "mode_kernels.h"
+#include "solution.h"
+
+using namespace QtDataVisualization;
+
+const float Benchmark::radius = 20.0f;
+const float Benchmark::waveSpeed = 200.0f;
+
+Benchmark::Benchmark(bool quick) {
+  if (quick) {
+    m_sampleCounts << 50 << 200;
+    m_modes << Mode{0.0f, 1} << Mode{5.0f, 3};
+    m_partialCounts << 256;
+    m_minimumTime = 20 * 1000 * 1000;
+  } else {
+    m_sampleCounts << 50 << 200 << 500 << 1000 << 2000;
+    m_modes << Mode{0.0f, 1} << Mode{5.0f, 3} << Mode{12.0f, 10}
+            << Mode{40.0f, 12};
+    m_partialCounts << 256 << 1024 << 4096;
+    m_minimumTime = 200 * 1000 * 1000;
+  }
+}
+
+QJsonObject Benchmark::run() {
+  m_results = QJsonArray();
+  for (const Mode& mode : m_modes) {
+    benchBesselRoot(mode);
+    benchBoostZero(mode);
+  }
+  for (int sampleCount : m_sampleCounts) {
+    for (const Mode& mode : m_modes) {
+      benchGenerateData(sampleCount, mode);
+      benchRadialSolution(sampleCount, mode);
+      benchBesselKernel(sampleCount, mode);
+      benchBoostBessel(sampleCount, mode);
+      benchUpdateFrame(sampleCount, mode);
+    }
+    benchNewSurfaceDataArray(sampleCount);
+    benchClearSurfaceDataArray(sampleCount);
+    benchFdtdStep(sampleCount);
+  }
+  for (int partialCount : m_partialCounts) benchDrumSynth(partialCount);
+  QJsonObject report;
+  report["qt_version"] = QString(qVersion());
+  report["threads"] = QThread::idealThreadCount();
+  report["minimum_time_ns"] = double(m_minimumTime);
+  report["peak_rss_bytes"] = double(alloc_counter::peakResidentBytes());
+  report["results"] = m_results;
+  return report;
+}
+
+// Cheap ops run in batches that double until a batch takes a millisecond,
+// so the timer overhead stays out of the result. Ops with a setup step run
+// one at a time.
+Benchmark::Measurement Benchmark::measure(std::function<void()> op,
+                                          std::function<void()> setup) {
+  if (setup) setup();
+  op();
+  QElapsedTimer timer;
+  qint64 elapsed = 0;
+  qint64 allocations = 0;
+  qint64 iterations = 0;
+  qint64 batch = 1;
+  while (elapsed < m_minimumTime) {
+    if (setup) setup();
+    qint64 allocationsBefore = alloc_counter::allocations();
+    timer.start();
+    for (qint64 i(0); i < batch; i++) op();
+    qint64 batchTime = timer.nsecsElapsed();
+    allocations += alloc_counter::allocations() - allocationsBefore;
+    elapsed += batchTime;
+    iterations += batch;
+    if (!setup && batchTime < 1000 * 1000) batch *= 2;
+  }
+  Measurement measurement = {iterations, double(elapsed) / iterations,
+                             double(allocations) / iterations};
+  return measurement;
+}
+
+void Benchmark::record(const QString& name, const QJsonObject& parameters,
+                       const Measurement& measurement, double maxError) {
+  QJsonObject result;
+  result["name"] = name;
+  result["parameters"] = parameters;
+  result["iterations"] = double(measurement.iterations);
+  result["ns_per_op"] = measurement.nsPerOp;
+  result["allocs_per_op"] = measurement.allocationsPerOp;
+  result["peak_rss_bytes"] = double(alloc_counter::peakResidentBytes());
+  if (maxError >= 0.0) result["max_abs_error"] = maxError;
+  m_results.append(result);
+  qInfo("%-28s %-40s %14.0f ns/op %10.1f allocs/op", qPrintable(name),
+        qPrintable(QString(QJsonDocument(parameters).toJson(
+            QJsonDocument::Compact))),
+        measurement.nsPerOp, measurement.allocationsPerOp);
+}
+
+QJsonObject Benchmark::parameters(int sampleCount, const Mode* mode) {
+  QJsonObject parameters;
+  if (sampleCount) parameters["sampleCount"] = sampleCount;
+  if (mode) {
+    parameters["n"] = double(mode->bessel_order_n);
+    parameters["m"] = mode->root_order_m;
+  }
+  return parameters;
+}
+
+void Benchmark::benchGenerateData(int sampleCount, Mode mode) {
+  Solution solution(sampleCount, radius, waveSpeed);
+  record("Solution::generateData", parameters(sampleCount, &mode),
+         measure([&]() {
+           solution.generateData(mode.bessel_order_n, mode.root_order_m);
+         }));
+}
+
+void Benchmark::benchBesselRoot(Mode mode) {
+  Solution solution(2, radius, waveSpeed);
+  volatile float sink = 0.0f;
+  record("Solution::get_bessel_root", parameters(0, &mode),
+         measure([&]() {
+           sink = solution.get_bessel_root(mode.bessel_order_n,
+                                           mode.root_order_m);
+         }));
+}
+
+void Benchmark::benchRadialSolution(int sampleCount, Mode mode) {
+  Solution solution(sampleCount, radius, waveSpeed);
+  const float* radii = solution.modeField().radii();
+  float bessel_root =
+      solution.get_bessel_root(mode.bessel_order_n, mode.root_order_m);
+  QVector<float> radial(sampleCount);
+  record("Solution::radial_solution", parameters(sampleCount, &mode),
+         measure([&]() {
+           solution.radial_solution(radii, bessel_root,
+                                    int(mode.bessel_order_n), radial.data(),
+                                    sampleCount);
+         }));
+}
+
+// The generic batch against the kernel specialized for the order, on the
+// arguments of a radial factor. Orders without a kernel only run the
+// generic case.
+void Benchmark::benchBesselKernel(int sampleCount, Mode mode) {
+  const int n = int(mode.bessel_order_n);
+  const double root = bessel::cyl_bessel_j_zero(n, mode.root_order_m);
+  QVector<float> arguments(sampleCount);
+  for (int j(0); j < sampleCount; j++)
+    arguments[j] = float(root * j / (sampleCount - 1));
+  QVector<float> values(sampleCount);
+  record("bessel::cyl_bessel_j", parameters(sampleCount, &mode),
+         measure([&]() {
+           bessel::cyl_bessel_j(n, arguments.constData(), values.data(),
+                                sampleCount);
+         }));
+  if (n > mode_kernels::maxOrder) return;
+  record("mode_kernels::cyl_bessel_j", parameters(sampleCount, &mode),
+         measure([&]() {
+           mode_kernels::cyl_bessel_j(n, arguments.constData(),
+                                      values.data(), sampleCount);
+         }));
+}
+
+// The double batch against Boost.Math, which the engine replaced, on the
+// same arguments; its error is the largest difference from Boost.
+void Benchmark::benchBoostBessel(int sampleCount, Mode mode) {
+  const int n = int(mode.bessel_order_n);
+  const double root = bessel::cyl_bessel_j_zero(n, mode.root_order_m);
+  QVector<double> arguments(sampleCount);
+  for (int j(0); j < sampleCount; j++)
+    arguments[j] = root * j / (sampleCount - 1);
+  QVector<double> reference(sampleCount);
+  QVector<double> values(sampleCount);
+  auto boostBatch = [&]() {
+    for (int j(0); j < sampleCount; j++)
+      reference[j] = boost::math::cyl_bessel_j(n, arguments[j]);
+  };
+  auto besselBatch = [&]() {
+    bessel::cyl_bessel_j(n, arguments.constData(), values.data(),
+                         sampleCount);
+  };
+  boostBatch();
+  besselBatch();
+  double error = 0.0;
+  for (int j(0); j < sampleCount; j++)
+    error = qMax(error, std::fabs(values[j] - reference[j]));
+  record("boost::math::cyl_bessel_j", parameters(sampleCount, &mode),
+         measure(boostBatch));
+  record("bessel::cyl_bessel_j(double)", parameters(sampleCount, &mode),
+         measure(besselBatch), error);
+}
+
+// Neither side caches roots.
+void Benchmark::benchBoostZero(Mode mode) {
+  const int n = int(mode.bessel_order_n);
+  const int m = mode.root_order_m;
+  volatile double sink = 0.0;
+  const double reference = boost::math::cyl_bessel_j_zero(double(n), m);
+  record("boost::math::cyl_bessel_j_zero", parameters(0, &mode),
+         measure([&]() {
+           sink = boost::math::cyl_bessel_j_zero(double(n), m);
+         }));
+  record("bessel::cyl_bessel_j_zero", parameters(0, &mode),
+         measure([&]() { sink = bessel::cyl_bessel_j_zero(n, m); }),
+         std::fabs(bessel::cyl_bessel_j_zero(n, m) - reference));
+}
+
+void Benchmark::benchNewSurfaceDataArray(int sampleCount) {
+  Solution solution(sampleCount, radius, waveSpeed);
+  QSurfaceDataArray* source = solution.modeField().newSurfaceDataArray(1.0f);
+  QSurfaceDataArray* array = 0;
+  auto release = [&]() {
+    if (!array) return;
+    clearSurfaceDataArray(*array);
+    delete array;
+    array = 0;
+  };
+  record("newSurfaceDataArrayFromSource", parameters(sampleCount, 0),
+         measure(
+             [&]() {
+               array = newSurfaceDataArrayFromSource(
+                   *source, [](QSurfaceDataItem& item) {
+                     item.setY(0.5f * item.y());
+                   });
+             },
+             release));
+  release();
+  clearSurfaceDataArray(*source);
+  delete source;
+}
+
+void Benchmark::benchClearSurfaceDataArray(int sampleCount) {
+  Solution solution(sampleCount, radius, waveSpeed);
+  QSurfaceDataArray* array = 0;
+  record("clearSurfaceDataArray", parameters(sampleCount, 0),
+         measure([&]() { clearSurfaceDataArray(*array); },
+                 [&]() {
+                   delete array;
+                   array = solution.modeField().newSurfaceDataArray(1.0f);
+                 }));
+  clearSurfaceDataArray(*array);
+  delete array;
+}
+
+// What Membrane::updateFrame does at 60 Hz: write the heights for the next
+// instant into the array owned by the proxy and hand it back to the proxy.
+void Benchmark::benchUpdateFrame(int sampleCount, Mode mode) {
+  Solution solution(sampleCount, radius, waveSpeed);
+  solution.generateData(mode.bessel_order_n, mode.root_order_m);
+  const ModeField& mode_field = solution.modeField();
+  QSurfaceDataProxy proxy;
+  QSurfaceDataArray* array = mode_field.newSurfaceDataArray(1.0f);
+  proxy.resetArray(array);
+  double t = 0.0;
+  record("Membrane::updateFrame", parameters(sampleCount, &mode),
+         measure([&]() {
+           t += 1.0 / 60.0;
+           mode_field.updateSurfaceDataArray(solution.temporalAt(t), *array);
+           proxy.resetArray(array);
+         }));
+}
+
+// One audio callback worth of samples. The decay is long enough that no
+// partial drops out while the case runs.
+void Benchmark::benchDrumSynth(int partialCount) {
+  Solution solution(2, radius, waveSpeed);
+  StrikeCondition strike = {0.3f, 0.0f, 0.02f, StrikeCondition::Strike};
+  DrumSynth synth(
+      DrumSynth::partials(
+          solution.strikeModes(strike, partialCount, ProgressCallback()),
+          DrumSynth::defaultFundamental, 1e6),
+      48000);
+  QVector<float> samples(DrumSynth::blockSize);
+  QJsonObject parameters;
+  parameters["partials"] = synth.partialCount();
+  parameters["frames"] = samples.size();
+  record("DrumSynth::render", parameters, measure([&]() {
+           synth.render(samples.data(), samples.size());
+         }));
+}
+
+// One leapfrog step of a strike on a membrane with varying tension, which
+// costs the same as the uniform one.
+void Benchmark::benchFdtdStep(int sampleCount) {
+  FdtdSolver solver(sampleCount, radius, waveSpeed);
+  solver.setTension([](float rho, float theta) {
+    return 1.0f + 0.3f * rho * std::cos(theta);
+  });
+  StrikeCondition strike = {0.3f, 0.0f, 0.1f, StrikeCondition::Strike};
+  solver.strike(strike);
+  record("FdtdSolver::step", parameters(sampleCount, 0),
+         measure([&]() { solver.step(); }));
+}
@@ -0,0 +1,84 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  Benchmark Class.
+  Headless timing of the computational hot paths.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonObject>
+#include <QtCore/QVector>
+#include <functional>
+
+// Times the hot paths of Solution, ModeField and qt_helpers over a matrix
+// of sample counts and (n, m) modes. Each case reports
+// ns/op, heap allocations per op and the process peak RSS so far.
+class Benchmark {
+ public:
+  struct Mode {
+    float bessel_order_n;
+    int root_order_m;
+  };
+
+  explicit Benchmark(bool quick = false);
+  QJsonObject run();
+
+ private:
+  struct Measurement {
+    qint64 iterations;
+    double nsPerOp;
+    double allocationsPerOp;
+  };
+
+  // Repeats op until minimumTime has been spent in it. setup, when given,
+  // runs untimed and uncounted before every op.
+  Measurement measure(std::function<void()> op,
+                      std::function<void()> setup = std::function<void()>());
+  // maxError, when not negative, is reported as max_abs_error.
+  void record(const QString& name, const QJsonObject& parameters,
+              const Measurement& measurement, double maxError = -1.0);
+  void benchGenerateData(int sampleCount, Mode mode);
+  void benchBesselRoot(Mode mode);
+  void benchRadialSolution(int sampleCount, Mode mode);
+  void benchBesselKernel(int sampleCount, Mode mode);
+  void benchBoostBessel(int sampleCount, Mode mode);
+  void benchBoostZero(Mode mode);
+  void benchNewSurfaceDataArray(int sampleCount);
+  void benchClearSurfaceDataArray(int sampleCount);
+  void benchUpdateFrame(int sampleCount, Mode mode);
+  void benchDrumSynth(int partialCount);
+  void benchFdtdStep(int sampleCount);
+  static QJsonObject parameters(int sampleCount, const Mode* mode);
+
+  const static float radius;
+  const static float waveSpeed;
+  QVector<int> m_sampleCounts;
+  QVector<Mode> m_modes;
+  QVector<int> m_partialCounts;
+  qint64 m_minimumTime;
+  QJsonArray m_results;
+};
+
+#endif
@@ -0,0 +1,31 @@
+#-------------------------------------------------
+#
+# Headless benchmarks of the computational core.
+# Run: benchmark [--quick] [--output results.json]
+#
+#-------------------------------------------------
+
+QT += core gui concurrent datavisualization
+QT -= widgets
+
+TARGET = benchmark
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# Boost, the reference of the Bessel comparison (change this to boost path
+# in your system).
+INCLUDEPATH += /home/spiros/.hunter/_Base/db6f548/0f5c128/2a3fb9f/Install/include
+
+SOURCES += \
+        main.cpp \
+        benchmark.cpp \
+        alloc_counter.cpp
+
+HEADERS += \
+        benchmark.h \
+        alloc_counter.h
+
+include(../core.pri)
@@ -0,0 +1,64 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  Benchmark entry point.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QTextStream>
+#include "benchmark.h"
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("benchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Times the circular membrane computations and prints JSON results.");
+    parser.addHelpOption();
+    QCommandLineOption quickOption("quick",
+        "Small matrix and short runs, for a smoke test.");
+    QCommandLineOption outputOption(QStringList() << "o" << "output",
+        "Write the JSON results to <file> instead of standard output.",
+        "file");
+    parser.addOption(quickOption);
+    parser.addOption(outputOption);
+    parser.process(app);
+
+    Benchmark benchmark(parser.isSet(quickOption));
+    QByteArray json = QJsonDocument(benchmark.run()).toJson();
+
+    if (!parser.isSet(outputOption)) {
+        QTextStream(stdout) << json;
+        return 0;
+    }
+    QFile output(parser.value(outputOption));
+    if (!output.open(QIODevice::WriteOnly) || output.write(json) != json.size()) {
+        qCritical("Cannot write %s", qPrintable(output.fileName()));
+        return 1;
+    }
+    return 0;
+}
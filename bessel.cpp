@@ -0,0 +1,471 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  Bessel functions.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "bessel.h"
+#include <cmath>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace bessel {
+namespace {
+
+const double kPi = 3.14159265358979323846;
+const double kTwoPi = 2 * kPi;
+const double kCbrtTwo = 1.25992104989487316;
+
+// Orders below this are handled by recurrence and the Hankel expansion only.
+const int kDebyeMinOrder = 25;
+// Orders from this on use the uniform Airy expansion near x = n,
+// lower orders fall back to recurrence there.
+const int kUniformMinOrder = 500;
+// Half width of the turning point region around x = n, in units of n^(1/3).
+const double kTurningPointWidth = 6.0;
+const int kHankelMaxTerms = 40;
+// Terms used by the SSE2 float Hankel path (enough for float accuracy
+// above the Hankel threshold).
+const int kHankelFloatTerms = 8;
+
+// Debye polynomials u_k(t), coefficients of t^0 .. t^(3k).
+const int kDebyeTerms = 7;
+const double kDebyeU[kDebyeTerms][19] = {
+    {1},
+    {0, 0.125, 0, -0.20833333333333334},
+    {0, 0, 0.0703125, 0, -0.40104166666666669, 0, 0.3342013888888889},
+    {0, 0, 0, 0.0732421875, 0, -0.89121093750000002, 0, 1.8464626736111112,
+     0, -1.0258125964506173},
+    {0, 0, 0, 0, 0.112152099609375, 0, -2.3640869140624998, 0,
+     8.78912353515625, 0, -11.207002616222994, 0, 4.6695844234262474},
+    {0, 0, 0, 0, 0, 0.22710800170898438, 0, -7.3687943594796321, 0,
+     42.534998745388457, 0, -91.818241543240021, 0, 84.636217674600729, 0,
+     -28.212072558200244},
+    {0, 0, 0, 0, 0, 0, 0.57250142097473145, 0, -26.491430486951554, 0,
+     218.19051174421159, 0, -699.57962737613252, 0, 1059.9904525279999, 0,
+     -765.25246814118168, 0, 212.57013003921713}};
+
+enum Regime {
+  Recurrence,
+  Hankel,
+  DebyeExponential,
+  DebyeOscillatory,
+  Uniform
+};
+
+// Order dependent constants, computed once per batch.
+struct Order {
+  explicit Order(int order)
+      : n(order),
+        mu(4.0 * order * order),
+        hankelMin(std::fmax(25.0, double(order) * order)),
+        turningWidth(kTurningPointWidth * std::cbrt(double(order))),
+        hankelPhase(std::fmod((0.5 * order + 0.25) * kPi, kTwoPi)) {}
+
+  Regime regime(double x) const {
+    if (n < kDebyeMinOrder) return x >= hankelMin ? Hankel : Recurrence;
+    double d = x - n;
+    if (d < -turningWidth) return DebyeExponential;
+    if (d > turningWidth) return DebyeOscillatory;
+    return n >= kUniformMinOrder ? Uniform : Recurrence;
+  }
+
+  int n;
+  double mu;
+  double hankelMin;
+  double turningWidth;
+  double hankelPhase;
+};
+
+// Miller's backward recurrence, normalized with J_0 + 2 sum J_2k = 1.
+double recurrence(int n, double x) {
+  const double big = 1.0e250;
+  const double small = 1.0e-250;
+  double top = std::fmax(double(n), x);
+  int start = 2 * ((int(top) + 16 + int(std::sqrt(40.0 * top))) / 2);
+  double tox = 2.0 / x;
+  double bjp = 0.0, bj = 1.0, ans = 0.0, sum = 0.0;
+  bool even = false;
+  for (int j = start; j > 0; j--) {
+    double bjm = j * tox * bj - bjp;
+    bjp = bj;
+    bj = bjm;
+    if (std::fabs(bj) > big) {
+      bj *= small;
+      bjp *= small;
+      ans *= small;
+      sum *= small;
+    }
+    if (even) sum += bj;
+    even = !even;
+    if (j == n) ans = bjp;
+  }
+  sum = 2.0 * sum - bj;
+  return n == 0 ? bj / sum : ans / sum;
+}
+
+double hankel(const Order& o, double x) {
+  double p = 1.0, q = 0.0, term = 1.0;
+  double eightX = 8.0 * x;
+  for (int k = 1; k < kHankelMaxTerms; k++) {
+    double odd = 2.0 * k - 1.0;
+    double next = term * (o.mu - odd * odd) / (k * eightX);
+    if (std::fabs(next) >= std::fabs(term) && k > 2) break;
+    term = next;
+    switch (k & 3) {
+      case 0: p += term; break;
+      case 1: q += term; break;
+      case 2: p -= term; break;
+      case 3: q -= term; break;
+    }
+    if (std::fabs(term) < 1.0e-17) break;
+  }
+  double chi = x - o.hankelPhase;
+  return std::sqrt(2.0 / (kPi * x)) * (p * std::cos(chi) - q * std::sin(chi));
+}
+
+double debyePolynomial(int k, double t) {
+  double value = 0.0;
+  for (int p = 3 * k; p >= 0; p--) value = value * t + kDebyeU[k][p];
+  return value;
+}
+
+// u_k(i c) with the factor i stripped for odd k.
+double debyePolynomialImaginary(int k, double c) {
+  double value = 0.0;
+  for (int p = 3 * k; p >= 0; p--) {
+    double a = kDebyeU[k][p];
+    value = value * c + (((p / 2) & 1) ? -a : a);
+  }
+  return value;
+}
+
+// x = n sech(alpha), x < n.
+double debyeExponential(int n, double x) {
+  double z = x / n;
+  double s = std::sqrt((1.0 - z) * (1.0 + z));
+  double exponent = n * (s - std::log((1.0 + s) / z));
+  if (exponent < -745.0) return 0.0;
+  double t = 1.0 / s;
+  double sum = 0.0, scale = 1.0;
+  for (int k = 0; k < kDebyeTerms; k++) {
+    sum += debyePolynomial(k, t) * scale;
+    scale /= n;
+  }
+  return std::exp(exponent) / std::sqrt(2.0 * kPi * n * s) * sum;
+}
+
+// x = n sec(beta), x > n.
+double debyeOscillatory(int n, double x) {
+  double root = std::sqrt((x - n) * (x + n));
+  double s = root / n;
+  double c = 1.0 / s;
+  double xi = root - n * std::atan(s) - 0.25 * kPi;
+  double even = 0.0, odd = 0.0, scale = 1.0;
+  for (int k = 0; k < kDebyeTerms; k++) {
+    if (k & 1)
+      odd += debyePolynomialImaginary(k, c) * scale;
+    else
+      even += debyePolynomialImaginary(k, c) * scale;
+    scale /= n;
+  }
+  return std::sqrt(2.0 / (kPi * root)) *
+         (std::cos(xi) * even + std::sin(xi) * odd);
+}
+
+void airy(double z, double& ai, double& aip) {
+  const double c1 = 0.355028053887817239;
+  const double c2 = 0.258819403792806798;
+  if (z > 5.0) {
+    double sqrtZ = std::sqrt(z);
+    double xi = 2.0 / 3.0 * z * sqrtZ;
+    double u = 1.0, su = 1.0, sv = 1.0, power = 1.0;
+    for (int k = 1; k < 12; k++) {
+      u *= (6.0 * k - 5.0) * (6.0 * k - 3.0) * (6.0 * k - 1.0) /
+           ((2.0 * k - 1.0) * 216.0 * k);
+      double v = -(6.0 * k + 1.0) / (6.0 * k - 1.0) * u;
+      power *= -1.0 / xi;
+      su += u * power;
+      sv += v * power;
+    }
+    double e = std::exp(-xi) / (2.0 * std::sqrt(kPi));
+    double z4 = std::sqrt(sqrtZ);
+    ai = e / z4 * su;
+    aip = -e * z4 * sv;
+    return;
+  }
+  double z3 = z * z * z;
+  double f = 1.0, g = z, fp = 0.5 * z * z, gp = 1.0;
+  double tf = 1.0, tg = z, tfp = fp, tgp = 1.0;
+  for (int k = 0; k < 200; k++) {
+    double k3 = 3.0 * k;
+    tf *= z3 / ((k3 + 2.0) * (k3 + 3.0));
+    tg *= z3 / ((k3 + 3.0) * (k3 + 4.0));
+    tfp *= z3 / ((k3 + 3.0) * (k3 + 5.0));
+    tgp *= z3 / ((k3 + 1.0) * (k3 + 3.0));
+    f += tf;
+    g += tg;
+    fp += tfp;
+    gp += tgp;
+    if (std::fabs(tf) + std::fabs(tg) + std::fabs(tfp) + std::fabs(tgp) <
+        1.0e-17 * (std::fabs(f) + std::fabs(g) + std::fabs(fp) + std::fabs(gp)))
+      break;
+  }
+  ai = c1 * f - c2 * g;
+  aip = c1 * fp - c2 * gp;
+}
+
+// Olver's uniform expansion, leading terms A_0 and B_0.
+double uniform(int n, double x) {
+  double z = x / n;
+  double w = 1.0 - z;
+  double zeta, ratio, b0;
+  if (std::fabs(w) < 1.0e-3) {
+    double series = 1.0 + 0.3 * w + 32.0 / 175.0 * w * w;
+    zeta = kCbrtTwo * w * series;
+    ratio = kCbrtTwo * series / (2.0 - w);
+    b0 = kCbrtTwo / 70.0;
+  } else {
+    double oneMinusZ2 = w * (1.0 + z);
+    if (z < 1.0) {
+      double s = std::sqrt(oneMinusZ2);
+      zeta = std::pow(1.5 * (std::log((1.0 + s) / z) - s), 2.0 / 3.0);
+      b0 = -5.0 / (48.0 * zeta * zeta) +
+           (5.0 / (24.0 * s * s * s) - 1.0 / (8.0 * s)) / std::sqrt(zeta);
+    } else {
+      double s = std::sqrt(-oneMinusZ2);
+      zeta = -std::pow(1.5 * (s - std::acos(1.0 / z)), 2.0 / 3.0);
+      b0 = -5.0 / (48.0 * zeta * zeta) +
+           (5.0 / (24.0 * s * s * s) + 1.0 / (8.0 * s)) / std::sqrt(-zeta);
+    }
+    ratio = zeta / oneMinusZ2;
+  }
+  double n13 = std::cbrt(double(n));
+  double n23 = n13 * n13;
+  double ai, aip;
+  airy(n23 * zeta, ai, aip);
+  return std::sqrt(std::sqrt(4.0 * ratio)) *
+         (ai / n13 + aip * b0 / (n * n23));
+}
+
+double evaluate(const Order& o, double x) {
+  if (x == 0.0) return o.n == 0 ? 1.0 : 0.0;
+  switch (o.regime(x)) {
+    case Hankel: return hankel(o, x);
+    case DebyeExponential: return debyeExponential(o.n, x);
+    case DebyeOscillatory: return debyeOscillatory(o.n, x);
+    case Uniform: return uniform(o.n, x);
+    case Recurrence: break;
+  }
+  return recurrence(o.n, x);
+}
+
+// J_{-n}(x) = (-1)^n J_n(x) and J_n(-x) = (-1)^n J_n(x).
+double sign(int n, double x) {
+  return (((n < 0) != (x < 0.0)) && (n & 1)) ? -1.0 : 1.0;
+}
+
+#if defined(__SSE2__)
+// sin and cos of arguments in [-pi, pi].
+void sincos_ps(__m128 x, __m128& s, __m128& c) {
+  const __m128 twoOverPi = _mm_set1_ps(0.636619772f);
+  __m128i q = _mm_cvtps_epi32(_mm_mul_ps(x, twoOverPi));
+  __m128 qf = _mm_cvtepi32_ps(q);
+  __m128 r = _mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(1.5707963705062866f)));
+  r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(-4.3711390e-8f)));
+  __m128 r2 = _mm_mul_ps(r, r);
+
+  __m128 sp = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), r2),
+                         _mm_set1_ps(8.3321608736e-3f));
+  sp = _mm_add_ps(_mm_mul_ps(sp, r2), _mm_set1_ps(-1.6666654611e-1f));
+  sp = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sp, r2), r), r);
+  __m128 cp = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), r2),
+                         _mm_set1_ps(-1.388731625493765e-3f));
+  cp = _mm_add_ps(_mm_mul_ps(cp, r2), _mm_set1_ps(4.166664568298827e-2f));
+  cp = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(cp, r2), r2),
+                  _mm_mul_ps(_mm_set1_ps(0.5f), r2));
+  cp = _mm_add_ps(cp, _mm_set1_ps(1.0f));
+
+  const __m128i one = _mm_set1_epi32(1);
+  const __m128i two = _mm_set1_epi32(2);
+  __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+  __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, two), 30));
+  __m128 cosSign = _mm_castsi128_ps(
+      _mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, one), two), 30));
+  s = _mm_or_ps(_mm_and_ps(swap, cp), _mm_andnot_ps(swap, sp));
+  c = _mm_or_ps(_mm_and_ps(swap, sp), _mm_andnot_ps(swap, cp));
+  s = _mm_xor_ps(s, sinSign);
+  c = _mm_xor_ps(c, cosSign);
+}
+
+// x - phase reduced to [-pi, pi], in double precision.
+__m128d reduce_pd(__m128d x, __m128d phase) {
+  const __m128d twoPi = _mm_set1_pd(kTwoPi);
+  __m128d chi = _mm_sub_pd(x, phase);
+  __m128d k = _mm_cvtepi32_pd(
+      _mm_cvtpd_epi32(_mm_mul_pd(chi, _mm_set1_pd(1.0 / kTwoPi))));
+  return _mm_sub_pd(chi, _mm_mul_pd(k, twoPi));
+}
+
+// Fixed-length Hankel expansion, four arguments at a time.
+void hankel_ps(const Order& o, const float* x, float* out, int count) {
+  float p[kHankelFloatTerms / 2], q[kHankelFloatTerms / 2];
+  double term = 1.0;
+  for (int k = 0; k < kHankelFloatTerms; k++) {
+    if (k > 0) {
+      double odd = 2.0 * k - 1.0;
+      term *= (o.mu - odd * odd) / (8.0 * k);
+    }
+    double signedTerm = ((k / 2) & 1) ? -term : term;
+    if (k & 1)
+      q[k / 2] = float(signedTerm);
+    else
+      p[k / 2] = float(signedTerm);
+  }
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 twoOverPi = _mm_set1_ps(float(2.0 / kPi));
+  const __m128d phase = _mm_set1_pd(o.hankelPhase);
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 vx = _mm_loadu_ps(x + i);
+    __m128 inv = _mm_div_ps(one, vx);
+    __m128 inv2 = _mm_mul_ps(inv, inv);
+    __m128 vp = _mm_set1_ps(p[kHankelFloatTerms / 2 - 1]);
+    __m128 vq = _mm_set1_ps(q[kHankelFloatTerms / 2 - 1]);
+    for (int k = kHankelFloatTerms / 2 - 2; k >= 0; k--) {
+      vp = _mm_add_ps(_mm_mul_ps(vp, inv2), _mm_set1_ps(p[k]));
+      vq = _mm_add_ps(_mm_mul_ps(vq, inv2), _mm_set1_ps(q[k]));
+    }
+    vq = _mm_mul_ps(vq, inv);
+
+    __m128d low = reduce_pd(_mm_cvtps_pd(vx), phase);
+    __m128d high = reduce_pd(_mm_cvtps_pd(_mm_movehl_ps(vx, vx)), phase);
+    __m128 chi = _mm_movelh_ps(_mm_cvtpd_ps(low), _mm_cvtpd_ps(high));
+    __m128 s, c;
+    sincos_ps(chi, s, c);
+
+    __m128 amplitude = _mm_sqrt_ps(_mm_mul_ps(twoOverPi, inv));
+    __m128 j = _mm_sub_ps(_mm_mul_ps(vp, c), _mm_mul_ps(vq, s));
+    _mm_storeu_ps(out + i, _mm_mul_ps(amplitude, j));
+  }
+  for (; i < count; i++) out[i] = float(hankel(o, x[i]));
+}
+#else
+void hankel_ps(const Order& o, const float* x, float* out, int count) {
+  for (int i = 0; i < count; i++) out[i] = float(hankel(o, x[i]));
+}
+#endif
+
+// McMahon's expansion, accurate for m >> n.
+double mcMahonZero(int n, int m) {
+  double mu = 4.0 * n * n;
+  double beta = (m + 0.5 * n - 0.25) * kPi;
+  double b8 = 8.0 * beta;
+  double b8_3 = b8 * b8 * b8;
+  return beta - (mu - 1.0) / b8 -
+         4.0 * (mu - 1.0) * (7.0 * mu - 31.0) / (3.0 * b8_3) -
+         32.0 * (mu - 1.0) * (83.0 * mu * mu - 982.0 * mu + 3779.0) /
+             (15.0 * b8_3 * b8 * b8);
+}
+
+// Olver's expansion j_{n,m} ~ n z(zeta), zeta = n^(-2/3) a_m, with a_m the
+// m-th zero of Ai; accurate for large n.
+double olverZero(int n, int m) {
+  double t = 3.0 * kPi * (4.0 * m - 1.0) / 8.0;
+  double t2 = 1.0 / (t * t);
+  double airyZero = std::pow(t, 2.0 / 3.0) *
+                    (1.0 + t2 * (5.0 / 48.0 - t2 * 5.0 / 36.0));
+  double zeta = airyZero / std::pow(double(n), 2.0 / 3.0);
+  // Solve sqrt(z^2 - 1) - arcsec(z) = 2/3 zeta^(3/2) for z > 1.
+  double g = 2.0 / 3.0 * zeta * std::sqrt(zeta);
+  double z = std::fmax(1.0 + std::pow(1.5 * g / std::sqrt(2.0), 2.0 / 3.0),
+                       g + 0.5 * kPi - 1.0);
+  for (int i = 0; i < 50; i++) {
+    double s = std::sqrt((z - 1.0) * (z + 1.0));
+    double dz = (s - std::acos(1.0 / z) - g) * z / s;
+    z -= dz;
+    if (z <= 1.0) z = 1.0 + 1.0e-12;
+    if (std::fabs(dz) < 1.0e-14 * z) break;
+  }
+  return n * z;
+}
+
+}  // namespace
+
+double cyl_bessel_j(int n, double x) {
+  Order order(std::abs(n));
+  return sign(n, x) * evaluate(order, std::fabs(x));
+}
+
+void cyl_bessel_j(int n, const double* x, double* out, int count) {
+  Order order(std::abs(n));
+  for (int i = 0; i < count; i++)
+    out[i] = sign(n, x[i]) * evaluate(order, std::fabs(x[i]));
+}
+
+// Arguments in the Hankel regime are gathered in blocks and evaluated with
+// the vectorized float kernel; the rest go through the double precision path.
+void cyl_bessel_j(int n, const float* x, float* out, int count) {
+  const int blockSize = 64;
+  Order order(std::abs(n));
+  float blockX[blockSize];
+  float blockJ[blockSize];
+  int blockIndex[blockSize];
+  int blockCount = 0;
+  auto flush = [&]() {
+    hankel_ps(order, blockX, blockJ, blockCount);
+    for (int b = 0; b < blockCount; b++) {
+      int i = blockIndex[b];
+      out[i] = float(sign(n, x[i])) * blockJ[b];
+    }
+    blockCount = 0;
+  };
+  for (int i = 0; i < count; i++) {
+    double xi = std::fabs(double(x[i]));
+    if (order.regime(xi) == Hankel) {
+      blockX[blockCount] = float(xi);
+      blockIndex[blockCount++] = i;
+      if (blockCount == blockSize) flush();
+    } else {
+      out[i] = float(sign(n, x[i]) * evaluate(order, xi));
+    }
+  }
+  if (blockCount) flush();
+}
+
+double cyl_bessel_j_zero(int n, int m) {
+  n = std::abs(n);
+  double x = (m > n) ? mcMahonZero(n, m) : olverZero(n, m);
+  Order order(n);
+  Order next(n + 1);
+  for (int i = 0; i < 50; i++) {
+    double j = evaluate(order, x);
+    double derivative = n / x * j - evaluate(next, x);
+    double dx = j / derivative;
+    x -= dx;
+    if (std::fabs(dx) < 1.0e-13 * x) break;
+  }
+  return x;
+}
+
+}  // namespace bessel
@@ -0,0 +1,48 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  Bessel functions.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef BESSEL_H
+#define BESSEL_H
+
+// Batched Bessel function engine.
+// J_n is evaluated for whole arrays of arguments at once; the order
+// dependent constants are set up once per batch and each argument is
+// routed to the cheapest accurate regime:
+//   - Miller backward recurrence (low orders, transition region),
+//   - Hankel asymptotic expansion (x >> n^2),
+//   - Debye expansions (large n, away from the turning point x = n),
+//   - Olver's uniform Airy expansion (large n, near the turning point).
+// The float batch evaluates the Hankel regime with SSE2 when available.
+//
+// cyl_bessel_j_zero finds the m-th positive zero j_{n,m} from a McMahon
+// (m >> n) or Olver (large n) asymptotic estimate refined with Newton.
+namespace bessel {
+double cyl_bessel_j(int n, double x);
+void cyl_bessel_j(int n, const double* x, double* out, int count);
+void cyl_bessel_j(int n, const float* x, float* out, int count);
+double cyl_bessel_j_zero(int n, int m);
+}
+
+#endif
@@ -0,0 +1,85 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  BesselZeros Class.
+  Lazily filled table of Bessel function zeros.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "bessel_zeros.h"
+#include <QtConcurrent/QtConcurrentMap>
+#include <limits>
+#include "bessel.h"
+
+const int BesselZeros::maxOrder = 10000;
+const int BesselZeros::maxRoot = 5000;
+
+namespace {
+const int minChunk = 64;
+}
+
+BesselZeros::BesselZeros()
+    : m_zeros(maxOrder + 1)
+{
+}
+
+BesselZeros& BesselZeros::instance() {
+  static BesselZeros zeros;
+  return zeros;
+}
+
+// Two threads missing the same row may both compute the chunk; the second
+// to take the lock only appends what the first did not.
+double BesselZeros::zero(int bessel_order_n, int root_order_m) {
+  Q_ASSERT(root_order_m >= 1);
+  if (root_order_m < 1) return std::numeric_limits<double>::quiet_NaN();
+  int n = qAbs(bessel_order_n);
+  if (n > maxOrder) return bessel::cyl_bessel_j_zero(n, root_order_m);
+  int size;
+  {
+    QReadLocker locker(&m_lock);
+    const QVector<double>& row = m_zeros.at(n);
+    if (root_order_m <= row.size()) return row.at(root_order_m - 1);
+    size = row.size();
+  }
+  int count = qMax(root_order_m, qMin(maxRoot, qMax(minChunk, 2 * size)));
+  QVector<double> chunk = compute(n, size + 1, count);
+  QWriteLocker locker(&m_lock);
+  QVector<double>& row = m_zeros[n];
+  for (int m = row.size() + 1; m <= count; m++) row << chunk.at(m - size - 1);
+  return row.at(root_order_m - 1);
+}
+
+// Roots first to last. Roots are independent of each other, each one is
+// an asymptotic estimate refined with Newton, so they are computed with a
+// parallel map.
+QVector<double> BesselZeros::compute(int bessel_order_n, int first,
+                                     int last) {
+  QVector<int> roots;
+  roots.reserve(last - first + 1);
+  for (int m = first; m <= last; m++) roots << m;
+  QVector<double> chunk(roots.size());
+  double* data = chunk.data();
+  QtConcurrent::blockingMap(roots, [bessel_order_n, first, data](int m) {
+    data[m - first] = bessel::cyl_bessel_j_zero(bessel_order_n, m);
+  });
+  return chunk;
+}
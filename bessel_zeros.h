@@ -0,0 +1,52 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  BesselZeros Class.
+  Lazily filled table of Bessel function zeros.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef BESSELZEROS_H
+#define BESSELZEROS_H
+
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QVector>
+
+// Process wide table of Bessel zeros j_{n,m}.
+// Rows are filled lazily, in parallel, in growing chunks of roots, so that
+// repeated lookups (frequency, frequency ratio, mode generation) are O(1).
+// A chunk is computed outside the lock, which is only held to append it.
+// Roots are numbered from 1; any other root_order_m gives NaN.
+class BesselZeros {
+ public:
+  const static int maxOrder;
+  const static int maxRoot;
+
+  static BesselZeros& instance();
+  double zero(int bessel_order_n, int root_order_m);
+ private:
+  BesselZeros();
+  static QVector<double> compute(int bessel_order_n, int first, int last);
+  QVector<QVector<double> > m_zeros;
+  QReadWriteLock m_lock;
+};
+
+#endif
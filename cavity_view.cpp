@@ -0,0 +1,252 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  CavityView Class.
+  Volume and slice rendering of spherical cavity modes.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "cavity_view.h"
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtDataVisualization/Q3DTheme>
+#include <QtDataVisualization/QValue3DAxis>
+#include <QtGui/QImage>
+#include <QtWidgets/QFileDialog>
+#include <QtWidgets/QHBoxLayout>
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QVBoxLayout>
+#include <cmath>
+#include "cavity_volume.h"
+
+const int CavityView::defaultDegree = 2;
+const int CavityView::defaultOrder = 1;
+const int CavityView::defaultRoot = 1;
+
+namespace {
+
+// Index 128 is psi = 0 and fully transparent; opacity grows with the
+// square of |psi|, so the lobes stand out and the weak tails stay clear.
+QVector<QRgb> colorTable() {
+  QVector<QRgb> colors(256);
+  for (int i(0); i < 256; i++) {
+    const int level = qAbs(i - 128);
+    const int alpha = qMin(255, level * level / 64);
+    colors[i] = i < 128 ? qRgba(40, 90, 255, alpha) : qRgba(255, 70, 40, alpha);
+  }
+  return colors;
+}
+
+}  // namespace
+
+CavityView::CavityView(float radius, QWidget* parent)
+    : QWidget(parent),
+      m_radius(radius),
+      m_graph(new Q3DScatter()),
+      m_volume(new QCustom3DVolume()),
+      m_size(0)
+{
+  setWindowTitle(QStringLiteral("Normal modes of a spherical cavity."));
+  m_pool.setMaxThreadCount(1);
+
+  // Volume items are only drawn with an orthographic projection.
+  m_graph->setOrthoProjection(true);
+  m_graph->setShadowQuality(QAbstract3DGraph::ShadowQualityNone);
+  m_graph->activeTheme()->setType(Q3DTheme::ThemeIsabelle);
+  m_graph->activeTheme()->setBackgroundEnabled(false);
+  m_graph->setAspectRatio(1.0);
+  m_graph->setHorizontalAspectRatio(1.0);
+  for (QValue3DAxis* axis : {m_graph->axisX(), m_graph->axisY(),
+                             m_graph->axisZ()})
+    axis->setRange(-radius, radius);
+
+  m_volume->setScalingAbsolute(false);
+  m_volume->setScaling(QVector3D(2 * radius, 2 * radius, 2 * radius));
+  m_volume->setPosition(QVector3D(0.0f, 0.0f, 0.0f));
+  m_volume->setTextureFormat(QImage::Format_Indexed8);
+  m_volume->setColorTable(colorTable());
+  m_volume->setUseHighDefShader(false);
+  m_volume->setDrawSliceFrames(false);
+
+  QWidget* container = QWidget::createWindowContainer(m_graph, this);
+  container->setMinimumSize(QSize(480, 480));
+  container->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+
+  m_degree = new QSpinBox(this);
+  m_degree->setRange(0, CavityVolume::maximumDegree);
+  m_degree->setPrefix("Degree l:    ");
+  m_order = new QSpinBox(this);
+  m_order->setPrefix("Order m:    ");
+  m_root = new QSpinBox(this);
+  m_root->setRange(1, CavityVolume::maximumRoot);
+  m_root->setPrefix("Root n:    ");
+  m_sizeList = new QComboBox(this);
+  for (int size = CavityVolume::defaultSize; size <= CavityVolume::maximumSize;
+       size *= 2)
+    m_sizeList->addItem(QString("%1 x %1 x %1").arg(size), size);
+  QPushButton* generateButton = new QPushButton("&Generate", this);
+  m_progress = new QProgressBar(this);
+  m_progress->setRange(0, 100);
+  m_label = new QLabel(this);
+  m_slices = new QCheckBox("Slice &Planes", this);
+  m_slice = new QSlider(Qt::Horizontal, this);
+  m_slice->setEnabled(false);
+  QPushButton* exportButton = new QPushButton("&Export Volume...", this);
+
+  QVBoxLayout* vLayout = new QVBoxLayout;
+  vLayout->setAlignment(Qt::AlignTop);
+  vLayout->addWidget(m_degree);
+  vLayout->addWidget(m_order);
+  vLayout->addWidget(m_root);
+  vLayout->addWidget(m_sizeList);
+  vLayout->addWidget(generateButton);
+  vLayout->addWidget(m_progress);
+  vLayout->addWidget(m_label);
+  vLayout->addWidget(m_slices);
+  vLayout->addWidget(m_slice);
+  vLayout->addWidget(exportButton);
+  QHBoxLayout* hLayout = new QHBoxLayout(this);
+  hLayout->addWidget(container, 1);
+  hLayout->addLayout(vLayout);
+
+  connect(m_degree, SIGNAL(valueChanged(int)), this, SLOT(setDegree(int)));
+  connect(generateButton, &QPushButton::clicked, this, &CavityView::generate);
+  connect(exportButton, &QPushButton::clicked, this,
+          &CavityView::exportVolume);
+  connect(m_slices, &QCheckBox::toggled, this, &CavityView::setSlicesVisible);
+  connect(m_slice, &QSlider::valueChanged, this, &CavityView::setSlice);
+  connect(&m_watcher, SIGNAL(finished()), this, SLOT(install()));
+  connect(&m_exportWatcher, SIGNAL(finished()), this, SLOT(finishExport()));
+
+  m_degree->setValue(defaultDegree);
+  setDegree(defaultDegree);
+  m_order->setValue(defaultOrder);
+  m_root->setValue(defaultRoot);
+  generate();
+}
+
+// The workers stop at their next slice once superseded or closing; the
+// graph owns the volume only after the first one is installed.
+CavityView::~CavityView() {
+  ++m_request;
+  m_closing = true;
+  m_watcher.waitForFinished();
+  m_exportWatcher.waitForFinished();
+  if (!m_graph->customItems().contains(m_volume)) delete m_volume;
+}
+
+void CavityView::setDegree(int degree_l) {
+  m_order->setRange(-degree_l, degree_l);
+}
+
+// Slice z of the volume is row z of every texture slice: the texture is
+// width x, height z (up), depth y.
+void CavityView::generate() {
+  const int request = ++m_request;
+  CavityVolume volume(m_degree->value(), m_order->value(), m_root->value(),
+                      m_radius);
+  volume.setSize(m_sizeList->currentData().toInt());
+  m_progress->setValue(0);
+  m_label->setText(QString("<b>x(%1, %2) = %3</b>")
+                       .arg(m_degree->value())
+                       .arg(m_root->value())
+                       .arg(volume.wavenumber() * m_radius, 0, 'f', 4));
+  m_watcher.setFuture(QtConcurrent::run(&m_pool, [this, request, volume]() {
+    const int size = volume.size();
+    const float scale = 127.0f / volume.peak();
+    QVector<uchar> texture(size * size * size);
+    auto progress = [this, request](int percent) -> bool {
+      if (request != m_request) return false;
+      QMetaObject::invokeMethod(this, "reportProgress", Qt::QueuedConnection,
+                                Q_ARG(int, request), Q_ARG(int, percent));
+      return true;
+    };
+    bool ok = volume.stream([&](int z, const float* values) {
+      for (int y(0); y < size; y++) {
+        uchar* row = texture.data() + (qint64(y) * size + z) * size;
+        const float* in = values + y * size;
+        for (int x(0); x < size; x++)
+          row[x] = uchar(qBound(0, 128 + qRound(scale * in[x]), 255));
+      }
+      return true;
+    }, progress);
+    return ok ? texture : QVector<uchar>();
+  }));
+}
+
+void CavityView::reportProgress(int request, int percent) {
+  if (request == m_request) m_progress->setValue(percent);
+}
+
+void CavityView::install() {
+  QVector<uchar> texture = m_watcher.result();
+  if (texture.isEmpty()) return;
+  m_size = qRound(std::cbrt(double(texture.size())));
+  m_volume->setTextureDimensions(m_size, m_size, m_size);
+  m_volume->setTextureData(new QVector<uchar>(texture));
+  if (!m_graph->customItems().contains(m_volume))
+    m_graph->addCustomItem(m_volume);
+  m_slice->setRange(0, m_size - 1);
+  m_slice->setValue(m_size / 2);
+  setSlice(m_slice->value());
+}
+
+void CavityView::setSlicesVisible(bool visible) {
+  m_volume->setDrawSlices(visible);
+  m_slice->setEnabled(visible);
+}
+
+// The slider moves the horizontal plane; the vertical ones stay centred.
+void CavityView::setSlice(int index) {
+  m_volume->setSliceIndices(m_size / 2, index, m_size / 2);
+}
+
+// The mode and size chosen in the panel, written as it is generated. One
+// export runs at a time.
+void CavityView::exportVolume() {
+  if (m_exportWatcher.isRunning()) return;
+  QString fileName = QFileDialog::getSaveFileName(
+      this, QStringLiteral("Export Volume"), QString(),
+      QStringLiteral("VTK (*.vtk)"));
+  if (fileName.isEmpty()) return;
+  CavityVolume volume(m_degree->value(), m_order->value(), m_root->value(),
+                      m_radius);
+  volume.setSize(m_sizeList->currentData().toInt());
+  m_exportFileName = fileName;
+  m_progress->setValue(0);
+  m_exportWatcher.setFuture(
+      QtConcurrent::run(&m_pool, [this, volume, fileName]() {
+    return volume.write(fileName, [this](int percent) -> bool {
+      if (m_closing) return false;
+      QMetaObject::invokeMethod(this, "reportExportProgress",
+                                Qt::QueuedConnection, Q_ARG(int, percent));
+      return true;
+    });
+  }));
+}
+
+void CavityView::reportExportProgress(int percent) {
+  m_progress->setValue(percent);
+}
+
+void CavityView::finishExport() {
+  if (!m_exportWatcher.result())
+    qWarning("Cannot write volume to %s", qPrintable(m_exportFileName));
+}
@@ -0,0 +1,101 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  CavityView Class.
+  Volume and slice rendering of spherical cavity modes.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef CAVITYVIEW_H
+#define CAVITYVIEW_H
+
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+#include <QtDataVisualization/Q3DScatter>
+#include <QtDataVisualization/QCustom3DVolume>
+#include <QtWidgets/QCheckBox>
+#include <QtWidgets/QComboBox>
+#include <QtWidgets/QLabel>
+#include <QtWidgets/QProgressBar>
+#include <QtWidgets/QSlider>
+#include <QtWidgets/QSpinBox>
+#include <QtWidgets/QWidget>
+#include <atomic>
+
+using namespace QtDataVisualization;
+
+// Window for the normal modes of a spherical cavity (CavityVolume), drawn
+// as a QCustom3DVolume on an empty scatter graph: translucent, red where
+// psi > 0 and blue where psi < 0, or as three slice planes through it.
+// Volumes are generated on a worker pool, off the GUI thread, and streamed
+// slice by slice straight into the 8 bit texture of the item, so the float
+// volume is never held. Every request supersedes the previous one, as in
+// ModeGenerator. Exports are written on the same pool and report on the
+// same progress bar. The polar axis of the harmonics is the vertical axis
+// of the graph.
+class CavityView : public QWidget {
+  Q_OBJECT
+
+ public:
+  const static int defaultDegree;
+  const static int defaultOrder;
+  const static int defaultRoot;
+
+  explicit CavityView(float radius, QWidget* parent = 0);
+  ~CavityView();
+
+ public Q_SLOTS:
+  void generate();
+  void exportVolume();
+  void setSlicesVisible(bool visible);
+  void setSlice(int index);
+
+ private Q_SLOTS:
+  void setDegree(int degree_l);
+  void reportProgress(int request, int percent);
+  void install();
+  void reportExportProgress(int percent);
+  void finishExport();
+
+ private:
+  float m_radius;
+  Q3DScatter* m_graph;
+  QCustom3DVolume* m_volume;
+  QSpinBox* m_degree;
+  QSpinBox* m_order;
+  QSpinBox* m_root;
+  QComboBox* m_sizeList;
+  QCheckBox* m_slices;
+  QSlider* m_slice;
+  QLabel* m_label;
+  QProgressBar* m_progress;
+  QThreadPool m_pool;
+  QFutureWatcher<QVector<uchar> > m_watcher;
+  QFutureWatcher<bool> m_exportWatcher;
+  std::atomic<int> m_request{0};
+  std::atomic<bool> m_closing{false};
+  QString m_exportFileName;
+  // Edge of the installed volume.
+  int m_size;
+};
+
+#endif
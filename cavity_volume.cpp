@@ -0,0 +1,330 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  CavityVolume Class.
+  Normal mode volumes of a spherical cavity.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "cavity_volume.h"
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QSaveFile>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QWaitCondition>
+#include <QtCore/QtEndian>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+const int CavityVolume::maximumDegree = 32;
+const int CavityVolume::maximumRoot = 16;
+const int CavityVolume::minimumSize = 16;
+const int CavityVolume::maximumSize = 512;
+const int CavityVolume::defaultSize = 128;
+// Radial samples per voxel: linear interpolation of j_l then errs by well
+// under the 1/256 an 8 bit volume resolves, up to the highest modes.
+const int CavityVolume::radialOversampling = 8;
+const int CavityVolume::polarSamples = 8192;
+
+CavityVolume::CavityVolume(int degree_l, int order_m, int root_n,
+                           float radius)
+    : m_degree(qBound(0, degree_l, maximumDegree)),
+      m_order(qBound(-m_degree, order_m, m_degree)),
+      m_root(qBound(1, root_n, maximumRoot)),
+      m_radius(radius),
+      m_size(defaultSize),
+      m_threadCount(0)
+{
+}
+
+// Rounded down to even: the polar angle of the centre is undefined.
+void CavityVolume::setSize(int size) {
+  m_size = qBound(minimumSize, size, maximumSize) & ~1;
+}
+
+void CavityVolume::setThreadCount(int count) {
+  m_threadCount = count;
+}
+
+int CavityVolume::size() const {
+  return m_size;
+}
+
+double CavityVolume::wavenumber() const {
+  return sphericalBesselZero(m_degree, m_root) / m_radius;
+}
+
+double CavityVolume::sphericalBessel(int degree_l, double x) {
+  const double sign = x < 0.0 && degree_l % 2 ? -1.0 : 1.0;
+  x = std::fabs(x);
+  if (x == 0.0) return degree_l == 0 ? 1.0 : 0.0;
+  const double j0 = std::sin(x) / x;
+  const double j1 = std::sin(x) / (x * x) - std::cos(x) / x;
+  if (degree_l == 0) return j0;
+  if (degree_l == 1) return sign * j1;
+  if (x > degree_l) {
+    double below = j0, current = j1;
+    for (int k(1); k < degree_l; k++) {
+      const double above = (2 * k + 1) / x * current - below;
+      below = current;
+      current = above;
+    }
+    return sign * current;
+  }
+  // Miller's algorithm: the minimal solution dominates going down, from
+  // any start far enough above l, and one known value fixes the scale.
+  const int start = degree_l + int(std::sqrt(40.0 * degree_l)) + 16;
+  double above = 0.0, current = 1.0, value = 0.0;
+  for (int k = start; k > 0; k--) {
+    const double below = (2 * k + 1) / x * current - above;
+    above = current;
+    current = below;
+    if (k - 1 == degree_l) value = current;
+    if (std::fabs(current) > 1e250) {
+      current *= 1e-250;
+      above *= 1e-250;
+      value *= 1e-250;
+    }
+  }
+  // current is now j_0 and above j_1, up to the common scale.
+  const double scale = std::fabs(j0) > std::fabs(j1) ? j0 / current
+                                                     : j1 / above;
+  return sign * value * scale;
+}
+
+// Zeros of j_l lie above l + 1/2 and more than pi / 2 apart, so half unit
+// steps bracket each one, and bisection refines it to double precision.
+double CavityVolume::sphericalBesselZero(int degree_l, int root_n) {
+  double a = degree_l + 0.5;
+  double fa = sphericalBessel(degree_l, a);
+  for (int found(0);;) {
+    const double b = a + 0.5;
+    const double fb = sphericalBessel(degree_l, b);
+    if ((fa < 0.0) != (fb < 0.0) && ++found == root_n) {
+      double lo = a, hi = b, flo = fa;
+      for (int i(0); i < 100 && hi - lo > 1e-15 * hi; i++) {
+        const double mid = 0.5 * (lo + hi);
+        const double fmid = sphericalBessel(degree_l, mid);
+        if ((fmid < 0.0) == (flo < 0.0)) {
+          lo = mid;
+          flo = fmid;
+        } else {
+          hi = mid;
+        }
+      }
+      return 0.5 * (lo + hi);
+    }
+    a = b;
+    fa = fb;
+  }
+}
+
+double CavityVolume::legendre(int degree_l, int order_m, double x) {
+  const double sine2 = (1.0 - x) * (1.0 + x);
+  double pmm = 1.0;
+  for (int i(1); i <= order_m; i++) pmm *= sine2 * (2 * i - 1) / (2 * i);
+  pmm = std::sqrt((2 * order_m + 1) * pmm / (4 * M_PI));
+  if (degree_l == order_m) return pmm;
+  double factor = std::sqrt(2.0 * order_m + 3.0);
+  double pmm1 = x * factor * pmm;
+  for (int l = order_m + 2; l <= degree_l; l++) {
+    const double next =
+        std::sqrt((4.0 * l * l - 1.0) / (double(l) * l - double(order_m) *
+                                                           order_m));
+    const double pl = (x * pmm1 - pmm / factor) * next;
+    factor = next;
+    pmm = pmm1;
+    pmm1 = pl;
+  }
+  return pmm1;
+}
+
+// The real harmonic of order m != 0 carries sqrt(2) over the complex one.
+CavityVolume::Tables CavityVolume::tables() const {
+  Tables tables;
+  const double k = wavenumber();
+  const int radialCount = radialOversampling * m_size;
+  tables.radial.resize(radialCount + 1);
+  for (int i(0); i <= radialCount; i++)
+    tables.radial[i] =
+        float(sphericalBessel(m_degree, k * m_radius * i / radialCount));
+
+  const int order = std::abs(m_order);
+  const double norm = order ? std::sqrt(2.0) : 1.0;
+  tables.polar.resize(polarSamples + 1);
+  for (int i(0); i <= polarSamples; i++)
+    tables.polar[i] = float(
+        norm * legendre(m_degree, order, qBound(-1.0, 2.0 * i / polarSamples -
+                                                          1.0, 1.0)));
+
+  tables.azimuthal.resize(m_size * m_size);
+  const double h = 2.0 / m_size;
+  for (int y(0); y < m_size; y++) {
+    for (int x(0); x < m_size; x++) {
+      const double phi = std::atan2((y + 0.5) * h - 1.0, (x + 0.5) * h - 1.0);
+      tables.azimuthal[y * m_size + x] =
+          float(m_order > 0 ? std::cos(order * phi)
+                            : m_order < 0 ? std::sin(order * phi) : 1.0);
+    }
+  }
+  return tables;
+}
+
+float CavityVolume::peak() const {
+  const Tables t = tables();
+  float radial = 0.0f, polar = 0.0f;
+  for (float value : t.radial) radial = qMax(radial, std::fabs(value));
+  for (float value : t.polar) polar = qMax(polar, std::fabs(value));
+  return radial * polar;
+}
+
+// Workers take slices in order and block while they are window slices
+// ahead of the consumer, so the slice it waits for is never blocked and
+// at most window slices are held at once.
+bool CavityVolume::stream(SliceConsumer consume,
+                          ProgressCallback progress) const {
+  const Tables tables = this->tables();
+  const int size = m_size;
+  const float h = 2.0f * m_radius / size;
+  const float radialScale =
+      float(radialOversampling * size) / m_radius;
+  const float polarScale = 0.5f * polarSamples;
+  auto fill = [&](int slice, float* values) {
+    const float z = (slice + 0.5f) * h - m_radius;
+    const float* radial = tables.radial.constData();
+    const float* polar = tables.polar.constData();
+    for (int y(0); y < size; y++) {
+      const float yy = (y + 0.5f) * h - m_radius;
+      const float* azimuthal = tables.azimuthal.constData() + y * size;
+      float* row = values + y * size;
+      for (int x(0); x < size; x++) {
+        const float xx = (x + 0.5f) * h - m_radius;
+        const float r = std::sqrt(xx * xx + yy * yy + z * z);
+        if (r >= m_radius) {
+          row[x] = 0.0f;
+          continue;
+        }
+        const float ri = r * radialScale;
+        const int i = int(ri);
+        const float a = radial[i] + (ri - i) * (radial[i + 1] - radial[i]);
+        const float ci = (z / r + 1.0f) * polarScale;
+        const int j = qMin(int(ci), polarSamples - 1);
+        const float b = polar[j] + (ci - j) * (polar[j + 1] - polar[j]);
+        row[x] = a * b * azimuthal[x];
+      }
+    }
+  };
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(m_threadCount > 0 ? m_threadCount
+                                           : QThread::idealThreadCount());
+  const int window = 2 * pool.maxThreadCount();
+  QMutex mutex;
+  QWaitCondition changed;
+  QMap<int, QVector<float> > ready;
+  int consumed = 0;
+  bool stopped = false;
+  std::atomic<int> next{0};
+
+  auto worker = [&]() {
+    for (int i = next++; i < size; i = next++) {
+      {
+        QMutexLocker locker(&mutex);
+        while (i >= consumed + window && !stopped) changed.wait(&mutex);
+        if (stopped) return;
+      }
+      QVector<float> slice(size * size);
+      fill(i, slice.data());
+      QMutexLocker locker(&mutex);
+      if (stopped) return;
+      ready.insert(i, slice);
+      changed.wakeAll();
+    }
+  };
+  QVector<QFuture<void> > futures;
+  for (int i(0); i < qMin(pool.maxThreadCount(), size); i++)
+    futures << QtConcurrent::run(&pool, worker);
+
+  bool ok = true;
+  for (int i(0); ok && i < size; i++) {
+    QVector<float> slice;
+    {
+      QMutexLocker locker(&mutex);
+      while (!ready.contains(i)) changed.wait(&mutex);
+      slice = ready.take(i);
+    }
+    ok = consume(i, slice.constData());
+    {
+      QMutexLocker locker(&mutex);
+      consumed = i + 1;
+      changed.wakeAll();
+    }
+    if (ok && progress) ok = progress(100 * (i + 1) / size);
+  }
+  {
+    QMutexLocker locker(&mutex);
+    stopped = true;
+    changed.wakeAll();
+  }
+  for (int i(0); i < futures.size(); i++) futures[i].waitForFinished();
+  return ok;
+}
+
+// VTK stores binary data big endian; slices go out as they arrive.
+bool CavityVolume::write(const QString& fileName,
+                         ProgressCallback progress) const {
+  QSaveFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly)) return false;
+  const double h = 2.0 * m_radius / m_size;
+  const double origin = 0.5 * h - m_radius;
+  QByteArray header = QString(
+      "# vtk DataFile Version 3.0\n"
+      "Spherical cavity mode l = %1, m = %2, n = %3\n"
+      "BINARY\n"
+      "DATASET STRUCTURED_POINTS\n"
+      "DIMENSIONS %4 %4 %4\n"
+      "ORIGIN %5 %5 %5\n"
+      "SPACING %6 %6 %6\n"
+      "POINT_DATA %7\n"
+      "SCALARS psi float 1\n"
+      "LOOKUP_TABLE default\n")
+      .arg(m_degree).arg(m_order).arg(m_root).arg(m_size)
+      .arg(origin, 0, 'g', 9).arg(h, 0, 'g', 9)
+      .arg(qint64(m_size) * m_size * m_size)
+      .toLatin1();
+  if (file.write(header) != header.size()) return false;
+  QVector<quint32> words(m_size * m_size);
+  bool ok = stream([&](int, const float* values) {
+    for (int i(0); i < words.size(); i++) {
+      quint32 word;
+      std::memcpy(&word, values + i, sizeof(word));
+      words[i] = qToBigEndian(word);
+    }
+    const qint64 bytes = qint64(words.size()) * sizeof(quint32);
+    return file.write(reinterpret_cast<const char*>(words.constData()),
+                      bytes) == bytes;
+  }, progress);
+  return ok && file.commit();
+}
@@ -0,0 +1,104 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  CavityVolume Class.
+  Normal mode volumes of a spherical cavity.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef CAVITYVOLUME_H
+#define CAVITYVOLUME_H
+
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#include <functional>
+#include "solution.h"
+
+// Normal modes of a spherical cavity of radius R with psi = 0 on the wall,
+//   psi(r, theta, phi) = j_l(k r) Y_l^m(theta, phi),  k = x_{l,n} / R,
+// x_{l,n} being the n-th zero of the spherical Bessel function j_l and
+// Y_l^m the real, orthonormal spherical harmonic: cos(m phi) for m > 0,
+// sin(|m| phi) for m < 0. The angular part is that of the hydrogen
+// orbitals; the sphere is the three dimensional drumhead.
+//
+// The mode is sampled on size^3 voxel centres of the cube [-R, R]^3, zero
+// outside the sphere; size is even, so no centre falls on r = 0. All of it is separable, so three small tables are
+// built by recurrence first: j_l over r, the normalized associated
+// Legendre function over cos(theta), and the azimuthal factor over the
+// (x, y) plane, which every slice shares. A voxel is then a square root
+// and three table lookups. Slices of constant z are filled by a pool of
+// workers and delivered in order; a worker may run at most a few slices
+// ahead of the consumer, so only those slices are held besides whatever
+// the consumer keeps.
+class CavityVolume {
+ public:
+  typedef std::function<bool(int slice, const float* values)> SliceConsumer;
+
+  const static int maximumDegree;
+  const static int maximumRoot;
+  const static int minimumSize;
+  const static int maximumSize;
+  const static int defaultSize;
+  const static int radialOversampling;
+  const static int polarSamples;
+
+  CavityVolume(int degree_l, int order_m, int root_n, float radius);
+  void setSize(int size);
+  void setThreadCount(int count);
+  int size() const;
+  double wavenumber() const;
+  // Largest |psi| in the cavity, from the tables: the factors depend on
+  // r, theta and phi alone, so it is the product of their maxima.
+  float peak() const;
+  // Slice z holds size x size values, x fastest, at z, y and x of
+  // (i + 1/2) 2 R / size - R. progress receives the percentage of slices
+  // delivered; either returning false cancels the stream.
+  bool stream(SliceConsumer consume,
+              ProgressCallback progress = ProgressCallback()) const;
+  // Legacy VTK structured points, binary, which ParaView and VisIt read.
+  bool write(const QString& fileName,
+             ProgressCallback progress = ProgressCallback()) const;
+
+  // j_l(x) by recurrence: upward from j_0 and j_1 where x > l, and
+  // downward from far above l, normalized by j_0 or j_1, below.
+  static double sphericalBessel(int degree_l, double x);
+  // The n-th positive zero of j_l.
+  static double sphericalBesselZero(int degree_l, int root_n);
+  // sqrt((2l+1)/(4 pi) (l-m)!/(l+m)!) P_l^m(x) for 0 <= m <= l, without
+  // the Condon-Shortley phase, by the stable recurrence in l.
+  static double legendre(int degree_l, int order_m, double x);
+
+ private:
+  struct Tables {
+    QVector<float> radial;
+    QVector<float> polar;
+    QVector<float> azimuthal;
+  };
+  Tables tables() const;
+  int m_degree;
+  int m_order;
+  int m_root;
+  float m_radius;
+  int m_size;
+  int m_threadCount;
+};
+
+#endif
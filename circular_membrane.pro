@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT += core gui datavisualization
+QT += core gui concurrent datavisualization network
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 # Boost  (change this to boost path in your system).
@@ -32,14 +32,44 @@ DEFINES += QT_DEPRECATED_WARNINGS
 SOURCES += \
         main.cpp \
         membrane.cpp \
-        solution.cpp \
-        qt_helpers.cpp
+        mode_generator.cpp \
+        metrics_panel.cpp \
+        batch_cli.cpp \
+        shader_view.cpp \
+        strike_panel.cpp \
+        spectrum_panel.cpp \
+        fdtd_panel.cpp \
+        query_server.cpp \
+        nodal_overlay.cpp \
+        cavity_view.cpp
 
 HEADERS += \
         membrane.h \
-        solution.h
-        qt_helpers.h
+        mode_generator.h \
+        metrics_panel.h \
+        batch_cli.h \
+        shader_view.h \
+        strike_panel.h \
+        spectrum_panel.h \
+        fdtd_panel.h \
+        query_server.h \
+        nodal_overlay.h \
+        cavity_view.h
+
+# Live sound needs Qt Multimedia; WAV export works without it.
+qtHaveModule(multimedia) {
+    QT += multimedia
+    DEFINES += DRUM_AUDIO_OUTPUT
+    SOURCES += drum_audio.cpp
+    HEADERS += drum_audio.h
+}
+
+include(core.pri)
 
 RESOURCES += membrane.qrc
 
+DISTFILES += \
+        shaders/membrane.vert \
+        shaders/membrane.frag
+
 
@@ -0,0 +1,45 @@
+# Computational core shared by the application and the headless tools.
+
+# The specialized Bessel kernels build their tables with C++14 constexpr.
+CONFIG += c++14
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+        $$PWD/solution.cpp \
+        $$PWD/mode_field.cpp \
+        $$PWD/mode_cache.cpp \
+        $$PWD/bessel.cpp \
+        $$PWD/bessel_zeros.cpp \
+        $$PWD/qt_helpers.cpp \
+        $$PWD/metrics.cpp \
+        $$PWD/mode_batch.cpp \
+        $$PWD/superposition.cpp \
+        $$PWD/drum_synth.cpp \
+        $$PWD/mode_spectrum.cpp \
+        $$PWD/fdtd_solver.cpp \
+        $$PWD/adaptive_grid.cpp \
+        $$PWD/mode_kernels.cpp \
+        $$PWD/mesh_export.cpp \
+        $$PWD/nodal_lines.cpp \
+        $$PWD/cavity_volume.cpp
+
+HEADERS += \
+        $$PWD/solution.h \
+        $$PWD/mode_field.h \
+        $$PWD/mode_cache.h \
+        $$PWD/bessel.h \
+        $$PWD/bessel_zeros.h \
+        $$PWD/qt_helpers.h \
+        $$PWD/metrics.h \
+        $$PWD/mode_batch.h \
+        $$PWD/superposition.h \
+        $$PWD/drum_synth.h \
+        $$PWD/mode_spectrum.h \
+        $$PWD/fdtd_solver.h \
+        $$PWD/adaptive_grid.h \
+        $$PWD/mode_kernels.h \
+        $$PWD/mesh_export.h \
+        $$PWD/nodal_lines.h \
+        $$PWD/cavity_volume.h
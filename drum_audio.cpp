@@ -0,0 +1,125 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  DrumAudio Class.
+  Streams the drum sound to the audio output.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "drum_audio.h"
+#include <QtMultimedia/QAudioDeviceInfo>
+#include <QtMultimedia/QAudioFormat>
+#include <QtMultimedia/QAudioOutput>
+#include <QtCore/QtEndian>
+
+// About 40 ms at 48 kHz: short enough to feel immediate, long enough for
+// the GUI thread to miss a few timer ticks without an underrun.
+const int DrumAudio::bufferFrames = 2048;
+
+DrumAudio::DrumAudio(QObject* parent)
+    : QIODevice(parent),
+      m_output(0),
+      m_voice(0),
+      m_samples(DrumSynth::blockSize)
+{
+}
+
+DrumAudio::~DrumAudio() {
+  stop();
+  delete m_voice;
+  delete m_pending.exchange(nullptr);
+  collectRetired();
+}
+
+bool DrumAudio::start() {
+  if (m_output) return true;
+  QAudioFormat format;
+  format.setSampleRate(DrumSynth::defaultSampleRate);
+  format.setChannelCount(1);
+  format.setSampleSize(16);
+  format.setCodec("audio/pcm");
+  format.setByteOrder(QAudioFormat::LittleEndian);
+  format.setSampleType(QAudioFormat::SignedInt);
+  QAudioDeviceInfo device = QAudioDeviceInfo::defaultOutputDevice();
+  if (device.isNull() || !device.isFormatSupported(format)) return false;
+  open(QIODevice::ReadOnly);
+  m_output = new QAudioOutput(device, format, this);
+  m_output->setBufferSize(bufferFrames * sizeof(qint16));
+  m_output->start(this);
+  if (m_output->error() == QAudio::NoError) return true;
+  delete m_output;
+  m_output = 0;
+  close();
+  return false;
+}
+
+void DrumAudio::stop() {
+  if (!m_output) return;
+  m_output->stop();
+  delete m_output;
+  m_output = 0;
+  close();
+}
+
+void DrumAudio::play(DrumSynth* synth) {
+  collectRetired();
+  // A voice that was never picked up is simply replaced.
+  delete m_pending.exchange(synth);
+}
+
+void DrumAudio::collectRetired() {
+  delete m_retired.exchange(nullptr);
+}
+
+// Picks up a pending voice only when the retired slot is free, so the
+// audio side never has to delete anything; otherwise the old voice keeps
+// playing until the next call.
+qint64 DrumAudio::readData(char* data, qint64 maxSize) {
+  if (m_pending.load(std::memory_order_acquire) &&
+      !m_retired.load(std::memory_order_acquire)) {
+    m_retired.store(m_voice, std::memory_order_release);
+    m_voice = m_pending.exchange(nullptr, std::memory_order_acq_rel);
+  }
+  qint16* out = reinterpret_cast<qint16*>(data);
+  qint64 frames = maxSize / qint64(sizeof(qint16));
+  for (qint64 done = 0; done < frames;) {
+    int count = int(qMin(qint64(m_samples.size()), frames - done));
+    if (m_voice) {
+      m_voice->render(m_samples.data(), count);
+      for (int i(0); i < count; i++)
+        out[done + i] = qToLittleEndian(qint16(
+            qRound(qBound(-1.0f, m_samples[i], 1.0f) * 32767.0f)));
+    } else {
+      for (int i(0); i < count; i++) out[done + i] = 0;
+    }
+    done += count;
+  }
+  return frames * qint64(sizeof(qint16));
+}
+
+qint64 DrumAudio::writeData(const char*, qint64) {
+  return -1;
+}
+
+// An endless stream: the output pulls as much as it can buffer.
+qint64 DrumAudio::bytesAvailable() const {
+  return bufferFrames * sizeof(qint16) + QIODevice::bytesAvailable();
+}
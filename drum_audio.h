@@ -0,0 +1,70 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  DrumAudio Class.
+  Streams the drum sound to the audio output.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef DRUMAUDIO_H
+#define DRUMAUDIO_H
+
+#include <QtCore/QIODevice>
+#include <QtCore/QVector>
+#include <atomic>
+#include "drum_synth.h"
+
+class QAudioOutput;
+
+// Streams DrumSynth voices to the default audio output, 16 bit mono, in
+// pull mode. A new voice is handed to the audio side through an atomic
+// slot and the replaced one comes back through another, so readData never
+// allocates, frees or locks; voices are created and deleted on the thread
+// that calls play().
+class DrumAudio : public QIODevice {
+  Q_OBJECT
+
+ public:
+  const static int bufferFrames;
+
+  explicit DrumAudio(QObject* parent = 0);
+  ~DrumAudio();
+  bool start();
+  void stop();
+  // Takes ownership of synth and plays it from the start, replacing the
+  // current voice.
+  void play(DrumSynth* synth);
+
+ protected:
+  qint64 readData(char* data, qint64 maxSize) override;
+  qint64 writeData(const char* data, qint64 maxSize) override;
+  qint64 bytesAvailable() const override;
+
+ private:
+  void collectRetired();
+  QAudioOutput* m_output;
+  DrumSynth* m_voice;
+  std::atomic<DrumSynth*> m_pending{nullptr};
+  std::atomic<DrumSynth*> m_retired{nullptr};
+  QVector<float> m_samples;
+};
+
+#endif
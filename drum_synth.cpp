@@ -0,0 +1,283 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  DrumSynth Class.
+  Modal synthesis of the drum sound.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "drum_synth.h"
+#include <QtCore/QSaveFile>
+#include <QtCore/QtEndian>
+#include <cmath>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+const int DrumSynth::blockSize = 256;
+const int DrumSynth::defaultSampleRate = 48000;
+const float DrumSynth::silence = 1e-5f;
+const double DrumSynth::defaultFundamental = 110.0;
+const double DrumSynth::defaultDecayTime = 1.5;
+
+namespace {
+
+// Long enough to contain the attack peak of any strike.
+const double gainWindow = 0.05;
+
+int paddedSize(int count) {
+  return (count + 3) & ~3;
+}
+
+template <typename T>
+bool writeValue(QIODevice* device, T value) {
+  value = qToLittleEndian(value);
+  return device->write(reinterpret_cast<const char*>(&value), sizeof(T)) ==
+         qint64(sizeof(T));
+}
+
+}  // namespace
+
+DrumSynth::DrumSynth(const QVector<Partial>& partials, int sampleRate)
+    : m_sampleRate(sampleRate),
+      m_partialCount(0),
+      m_active(0),
+      m_frame(0),
+      m_gain(1.0f),
+      m_threshold(0.0)
+{
+  // Partials at or above Nyquist would alias.
+  for (const Partial& partial : partials) {
+    if (partial.frequency <= 0.0 || partial.frequency >= 0.5 * sampleRate ||
+        (partial.cosine == 0.0f && partial.sine == 0.0f))
+      continue;
+    m_omega.append(2 * M_PI * partial.frequency);
+    m_decay.append(partial.decay);
+    m_cosine.append(partial.cosine);
+    m_sine.append(partial.sine);
+    m_threshold = qMax(m_threshold, double(std::hypot(partial.cosine,
+                                                      partial.sine)));
+  }
+  m_threshold *= silence;
+  m_partialCount = m_omega.size();
+  int padded = paddedSize(m_partialCount);
+  m_re.fill(0.0f, padded);
+  m_im.fill(0.0f, padded);
+  m_rotationRe.fill(1.0f, padded);
+  m_rotationIm.fill(0.0f, padded);
+  for (int i(0); i < m_partialCount; i++) {
+    double damping = std::exp(-m_decay[i] / sampleRate);
+    m_rotationRe[i] = float(damping * std::cos(m_omega[i] / sampleRate));
+    m_rotationIm[i] = float(damping * std::sin(m_omega[i] / sampleRate));
+  }
+  m_lanes.fill(0.0f, 4 * blockSize);
+
+  QVector<float> attack(qMax(1, int(gainWindow * sampleRate)));
+  restart();
+  render(attack.data(), attack.size());
+  float peak = 0.0f;
+  for (float sample : attack) peak = qMax(peak, std::fabs(sample));
+  if (peak > 0.0f) m_gain = 0.9f / peak;
+  restart();
+}
+
+QVector<DrumSynth::Partial> DrumSynth::partials(
+    const QVector<Superposition::Mode>& modes, double fundamental,
+    double decayTime) {
+  QVector<Partial> partials;
+  if (modes.isEmpty()) return partials;
+  double lowest = modes[0].omega;
+  for (const Superposition::Mode& mode : modes)
+    lowest = qMin(lowest, mode.omega);
+  const double decay = std::log(1000.0) / decayTime;
+  partials.reserve(modes.size());
+  for (const Superposition::Mode& mode : modes) {
+    // d/dt (A cos wt + B sin wt) = w (B cos wt - A sin wt)
+    double ratio = mode.omega / lowest;
+    Partial partial = {fundamental * ratio, decay * ratio,
+                       float(ratio * mode.sine), float(-ratio * mode.cosine)};
+    partials.append(partial);
+  }
+  return partials;
+}
+
+int DrumSynth::sampleRate() const {
+  return m_sampleRate;
+}
+
+int DrumSynth::partialCount() const {
+  return m_partialCount;
+}
+
+int DrumSynth::activePartialCount() const {
+  return m_active;
+}
+
+bool DrumSynth::isFinished() const {
+  return m_active == 0;
+}
+
+double DrumSynth::time() const {
+  return double(m_frame) / m_sampleRate;
+}
+
+void DrumSynth::restart() {
+  m_frame = 0;
+  m_active = m_partialCount;
+  resync();
+}
+
+// z_i(t) = exp(-sigma_i t) (S_i + i C_i) exp(i w_i t), whose imaginary part
+// is the damped C_i cos(w_i t) + S_i sin(w_i t). Partials below the
+// threshold are swapped past m_active and their padding lanes zeroed.
+void DrumSynth::resync() {
+  const double t = time();
+  int i = 0;
+  while (i < m_active) {
+    double damping = std::exp(-m_decay[i] * t);
+    if (damping * std::hypot(m_cosine[i], m_sine[i]) < m_threshold) {
+      m_active--;
+      std::swap(m_omega[i], m_omega[m_active]);
+      std::swap(m_decay[i], m_decay[m_active]);
+      std::swap(m_cosine[i], m_cosine[m_active]);
+      std::swap(m_sine[i], m_sine[m_active]);
+      std::swap(m_rotationRe[i], m_rotationRe[m_active]);
+      std::swap(m_rotationIm[i], m_rotationIm[m_active]);
+      continue;
+    }
+    double phase = std::fmod(m_omega[i] * t, 2 * M_PI);
+    double c = std::cos(phase);
+    double s = std::sin(phase);
+    m_re[i] = float(damping * (m_sine[i] * c - m_cosine[i] * s));
+    m_im[i] = float(damping * (m_sine[i] * s + m_cosine[i] * c));
+    i++;
+  }
+  for (int j = m_active; j < paddedSize(m_active); j++) {
+    m_re[j] = 0.0f;
+    m_im[j] = 0.0f;
+  }
+}
+
+void DrumSynth::render(float* out, int frames) {
+  while (frames > 0) {
+    if (m_frame % blockSize == 0) resync();
+    int count = qMin(frames, int(blockSize - m_frame % blockSize));
+    if (m_active)
+      renderBlock(out, count);
+    else
+      std::memset(out, 0, count * sizeof(float));
+    out += count;
+    frames -= count;
+    m_frame += count;
+  }
+}
+
+// Groups of four partials stay in registers for the whole block while
+// their imaginary parts accumulate into m_lanes, four lanes per sample;
+// the lanes are summed once at the end.
+void DrumSynth::renderBlock(float* out, int frames) {
+  float* lanes = m_lanes.data();
+  std::memset(lanes, 0, 4 * frames * sizeof(float));
+  const int padded = paddedSize(m_active);
+#if defined(__SSE2__)
+  for (int i = 0; i < padded; i += 4) {
+    __m128 re = _mm_loadu_ps(m_re.constData() + i);
+    __m128 im = _mm_loadu_ps(m_im.constData() + i);
+    const __m128 rotationRe = _mm_loadu_ps(m_rotationRe.constData() + i);
+    const __m128 rotationIm = _mm_loadu_ps(m_rotationIm.constData() + i);
+    for (int s = 0; s < frames; s++) {
+      _mm_storeu_ps(lanes + 4 * s, _mm_add_ps(_mm_loadu_ps(lanes + 4 * s), im));
+      __m128 nextRe = _mm_sub_ps(_mm_mul_ps(re, rotationRe),
+                                 _mm_mul_ps(im, rotationIm));
+      im = _mm_add_ps(_mm_mul_ps(re, rotationIm), _mm_mul_ps(im, rotationRe));
+      re = nextRe;
+    }
+    _mm_storeu_ps(m_re.data() + i, re);
+    _mm_storeu_ps(m_im.data() + i, im);
+  }
+#else
+  for (int i = 0; i < padded; i += 4) {
+    float re[4], im[4], rotationRe[4], rotationIm[4];
+    for (int k = 0; k < 4; k++) {
+      re[k] = m_re[i + k];
+      im[k] = m_im[i + k];
+      rotationRe[k] = m_rotationRe[i + k];
+      rotationIm[k] = m_rotationIm[i + k];
+    }
+    for (int s = 0; s < frames; s++) {
+      for (int k = 0; k < 4; k++) {
+        lanes[4 * s + k] += im[k];
+        float nextRe = re[k] * rotationRe[k] - im[k] * rotationIm[k];
+        im[k] = re[k] * rotationIm[k] + im[k] * rotationRe[k];
+        re[k] = nextRe;
+      }
+    }
+    for (int k = 0; k < 4; k++) {
+      m_re[i + k] = re[k];
+      m_im[i + k] = im[k];
+    }
+  }
+#endif
+  for (int s = 0; s < frames; s++)
+    out[s] = m_gain * ((lanes[4 * s] + lanes[4 * s + 1]) +
+                       (lanes[4 * s + 2] + lanes[4 * s + 3]));
+}
+
+// Canonical 44 byte RIFF header followed by the samples. Renders from the
+// strike on and leaves the synth at the end of the written sound.
+bool DrumSynth::writeWav(const QString& fileName, double seconds,
+                         ProgressCallback progress) {
+  const quint32 frames = quint32(qMax(0.0, seconds) * m_sampleRate);
+  const quint32 dataBytes = frames * sizeof(qint16);
+  QSaveFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly)) return false;
+  bool ok = file.write("RIFF", 4) == 4 &&
+            writeValue(&file, quint32(36 + dataBytes)) &&
+            file.write("WAVEfmt ", 8) == 8 && writeValue(&file, quint32(16)) &&
+            writeValue(&file, quint16(1)) && writeValue(&file, quint16(1)) &&
+            writeValue(&file, quint32(m_sampleRate)) &&
+            writeValue(&file, quint32(m_sampleRate * sizeof(qint16))) &&
+            writeValue(&file, quint16(sizeof(qint16))) &&
+            writeValue(&file, quint16(16)) && file.write("data", 4) == 4 &&
+            writeValue(&file, dataBytes);
+
+  restart();
+  const int chunk = 16 * blockSize;
+  QVector<float> samples(chunk);
+  QVector<qint16> pcm(chunk);
+  for (quint32 written = 0; ok && written < frames;) {
+    int count = int(qMin(quint32(chunk), frames - written));
+    render(samples.data(), count);
+    for (int i(0); i < count; i++)
+      pcm[i] = qToLittleEndian(
+          qint16(qRound(qBound(-1.0f, samples[i], 1.0f) * 32767.0f)));
+    ok = file.write(reinterpret_cast<const char*>(pcm.constData()),
+                    count * sizeof(qint16)) == qint64(count * sizeof(qint16));
+    written += count;
+    if (ok && progress) ok = progress(int(100.0 * written / frames));
+  }
+  if (!ok) {
+    file.cancelWriting();
+    return false;
+  }
+  return file.commit();
+}
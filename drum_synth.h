@@ -0,0 +1,103 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  DrumSynth Class.
+  Modal synthesis of the drum sound.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef DRUMSYNTH_H
+#define DRUMSYNTH_H
+
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#include "solution.h"
+#include "superposition.h"
+
+// Damped additive synthesis of a struck membrane: every partial is a
+// complex phasor z = a exp((-sigma + i w) t) and the output is the sum of
+// their imaginary parts.
+// Partials are stored as separate float arrays, padded to groups of four,
+// and advanced one rotation per sample, four at a time with SSE2 where
+// available. Once per block the phasors are recomputed exactly in double
+// precision, so float rounding never accumulates, and partials that have
+// decayed below audibility are dropped from the bank.
+// render() neither allocates nor locks and can run in an audio callback.
+class DrumSynth {
+ public:
+  struct Partial {
+    double frequency;  // Hz
+    double decay;      // sigma, 1/s
+    float cosine;      // output is cosine cos(w t) + sine sin(w t), damped
+    float sine;
+  };
+
+  const static int blockSize;
+  // Of playback and of exported sound alike.
+  const static int defaultSampleRate;
+  const static float silence;
+  const static double defaultFundamental;
+  const static double defaultDecayTime;
+
+  DrumSynth(const QVector<Partial>& partials, int sampleRate);
+  // One partial per mode, tuned so that mode (0, 1) sounds at fundamental
+  // Hz. Each partial follows the velocity of its mode, which is what
+  // radiates; decayTime is the 60 dB decay of the fundamental and higher
+  // partials decay proportionally faster.
+  static QVector<Partial> partials(const QVector<Superposition::Mode>& modes,
+                                   double fundamental = defaultFundamental,
+                                   double decayTime = defaultDecayTime);
+  int sampleRate() const;
+  int partialCount() const;
+  int activePartialCount() const;
+  bool isFinished() const;
+  double time() const;
+  void restart();
+  // Writes frames mono samples, silence once every partial has decayed.
+  void render(float* out, int frames);
+  // 16 bit mono PCM of the first seconds of the sound.
+  bool writeWav(const QString& fileName, double seconds,
+                ProgressCallback progress = ProgressCallback());
+
+ private:
+  void resync();
+  void renderBlock(float* out, int frames);
+
+  int m_sampleRate;
+  int m_partialCount;
+  int m_active;
+  qint64 m_frame;
+  float m_gain;
+  double m_threshold;
+  // Per partial, in double for the exact resync.
+  QVector<double> m_omega;
+  QVector<double> m_decay;
+  QVector<double> m_cosine;
+  QVector<double> m_sine;
+  // Per partial phasor and rotation, float, padded to a multiple of four.
+  QVector<float> m_re;
+  QVector<float> m_im;
+  QVector<float> m_rotationRe;
+  QVector<float> m_rotationIm;
+  QVector<float> m_lanes;
+};
+
+#endif
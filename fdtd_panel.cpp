@@ -0,0 +1,103 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  FdtdPanel Class.
+  Medium and status of the finite difference solver.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "fdtd_panel.h"
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QVBoxLayout>
+#include <cmath>
+
+FdtdPanel::FdtdPanel(QWidget* parent)
+    : QGroupBox(QStringLiteral("Finite Differences"), parent)
+{
+  setCheckable(true);
+  setChecked(false);
+
+  m_damping = new QDoubleSpinBox(this);
+  m_damping->setRange(0.0, 100.0);
+  m_damping->setSingleStep(0.5);
+  m_damping->setPrefix("Damping:    ");
+  m_damping->setSuffix(" 1/s");
+
+  m_tensionVariation = new QDoubleSpinBox(this);
+  m_tensionVariation->setRange(0.0, 0.9);
+  m_tensionVariation->setSingleStep(0.1);
+  m_tensionVariation->setPrefix("Tension Variation:    ");
+
+  m_rimDensity = new QDoubleSpinBox(this);
+  m_rimDensity->setRange(0.1, 10.0);
+  m_rimDensity->setSingleStep(0.1);
+  m_rimDensity->setValue(1.0);
+  m_rimDensity->setPrefix("Rim Density:    ");
+  m_rimDensity->setSuffix(" x");
+
+  QPushButton* restartButton = new QPushButton("Restart from &Mode", this);
+  m_status = new QLabel(this);
+
+  QVBoxLayout* vBox = new QVBoxLayout;
+  vBox->addWidget(m_damping);
+  vBox->addWidget(m_tensionVariation);
+  vBox->addWidget(m_rimDensity);
+  vBox->addWidget(restartButton);
+  vBox->addWidget(m_status);
+  setLayout(vBox);
+
+  connect(m_damping, SIGNAL(valueChanged(double)), this,
+          SIGNAL(mediumChanged()));
+  connect(m_tensionVariation, SIGNAL(valueChanged(double)), this,
+          SIGNAL(mediumChanged()));
+  connect(m_rimDensity, SIGNAL(valueChanged(double)), this,
+          SIGNAL(mediumChanged()));
+  connect(restartButton, &QPushButton::clicked, this,
+          &FdtdPanel::restartRequested);
+}
+
+// Uniform values leave the profiles empty, which keeps the solver ideal.
+void FdtdPanel::configure(FdtdSolver* solver) const {
+  const float variation = float(m_tensionVariation->value());
+  const float rimDensity = float(m_rimDensity->value());
+  solver->setDamping(m_damping->value());
+  solver->setTension(variation == 0.0f
+                         ? FdtdSolver::Profile()
+                         : [variation](float rho, float theta) {
+                             return 1.0f + variation * rho * std::cos(theta);
+                           });
+  solver->setDensity(rimDensity == 1.0f
+                         ? FdtdSolver::Profile()
+                         : [rimDensity](float rho, float) {
+                             return 1.0f + (rimDensity - 1.0f) * rho * rho;
+                           });
+}
+
+void FdtdPanel::setStatus(double timeStep, int stepsPerFrame,
+                          float deviation) {
+  QString status = QString("dt = %1 us, %2 steps/frame")
+                       .arg(timeStep * 1e6, 0, 'f', 2)
+                       .arg(stepsPerFrame);
+  if (deviation >= 0.0f)
+    status += QString("<br>Deviation from Solution: %1")
+                  .arg(double(deviation), 0, 'f', 4);
+  m_status->setText(status);
+}
@@ -0,0 +1,60 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  FdtdPanel Class.
+  Medium and status of the finite difference solver.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef FDTDPANEL_H
+#define FDTDPANEL_H
+
+#include <QtWidgets/QDoubleSpinBox>
+#include <QtWidgets/QGroupBox>
+#include <QtWidgets/QLabel>
+#include "fdtd_solver.h"
+
+// Checkable side panel that switches the view to the finite difference
+// solver and describes its medium: damping, an angular tension variation
+// T = 1 + a (r / R) cos(theta) and a density rising to a given ratio at
+// the rim, rho = 1 + (d - 1) (r / R)^2.
+class FdtdPanel : public QGroupBox {
+  Q_OBJECT
+
+ public:
+  explicit FdtdPanel(QWidget* parent = 0);
+  // Applies the medium of the panel to solver.
+  void configure(FdtdSolver* solver) const;
+  // deviation < 0 when there is no analytic reference.
+  void setStatus(double timeStep, int stepsPerFrame, float deviation);
+
+ Q_SIGNALS:
+  void mediumChanged();
+  void restartRequested();
+
+ private:
+  QDoubleSpinBox* m_damping;
+  QDoubleSpinBox* m_tensionVariation;
+  QDoubleSpinBox* m_rimDensity;
+  QLabel* m_status;
+};
+
+#endif
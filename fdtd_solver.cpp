@@ -0,0 +1,432 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  FdtdSolver Class.
+  Finite difference time domain solver for non-ideal membranes.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "fdtd_solver.h"
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QThread>
+#include <cmath>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "bessel.h"
+#include "metrics.h"
+#include "qt_helpers.h"
+
+using namespace qt_helpers;
+
+const double FdtdSolver::courantSafety = 0.9;
+// Three rows of a tile, plus its four coupling rows, fit in L1.
+const int FdtdSolver::tileColumns = 512;
+// Below this many nodes a step is too short to be worth a thread hand-off.
+const int FdtdSolver::parallelNodes = 256 * 256;
+const int FdtdSolver::maxStepsPerAdvance = 20000;
+// Half a frame at 60 Hz, leaving the rest to the surface upload.
+const qint64 FdtdSolver::maxAdvanceTime = 8;
+
+FdtdSolver::FdtdSolver(int sampleCount, float radius, float wave_speed)
+    : m_rows(sampleCount),
+      m_columns(sampleCount),
+      m_angles(sampleCount - 1),
+      m_stride(sampleCount + 1),
+      m_radius(radius),
+      m_wave_speed(wave_speed),
+      m_dr(radius / double(sampleCount - 1)),
+      m_dtheta(2 * M_PI / (sampleCount - 1)),
+      m_damping(0.0),
+      m_maxStep(0.0),
+      m_dt(0.0),
+      m_c0(2.0f),
+      m_c1(1.0f),
+      m_c2(0.0f),
+      m_time(0.0),
+      m_pending(0.0),
+      m_steps(0),
+      m_current(sampleCount * (sampleCount + 1), 0.0f),
+      m_last(sampleCount * (sampleCount + 1), 0.0f),
+      m_threadPool(new QThreadPool())
+{
+  updateCoefficients();
+}
+
+FdtdSolver::~FdtdSolver() {
+  m_threadPool->waitForDone();
+  delete m_threadPool;
+}
+
+int FdtdSolver::rowCount() const {
+  return m_rows;
+}
+
+int FdtdSolver::columnCount() const {
+  return m_columns;
+}
+
+void FdtdSolver::setThreadCount(int count) {
+  m_threadPool->setMaxThreadCount(count > 0 ? count
+                                            : QThread::idealThreadCount());
+}
+
+void FdtdSolver::setTension(Profile tension) {
+  m_tension = tension;
+  updateCoefficients();
+}
+
+void FdtdSolver::setDensity(Profile density) {
+  m_density = density;
+  updateCoefficients();
+}
+
+void FdtdSolver::setDamping(double damping) {
+  m_damping = damping;
+  setTimeStep(m_dt);
+}
+
+double FdtdSolver::damping() const {
+  return m_damping;
+}
+
+double FdtdSolver::timeStep() const {
+  return m_dt;
+}
+
+double FdtdSolver::time() const {
+  return m_time;
+}
+
+qint64 FdtdSolver::stepCount() const {
+  return m_steps;
+}
+
+bool FdtdSolver::isIdeal() const {
+  return m_damping == 0.0 && !m_tension && !m_density;
+}
+
+float* FdtdSolver::row(QVector<float>& buffer, int i) {
+  return buffer.data() + i * m_stride;
+}
+
+const float* FdtdSolver::row(const QVector<float>& buffer, int i) const {
+  return buffer.constData() + i * m_stride;
+}
+
+// Flux form: the coupling across a cell face uses the tension on that
+// face, so the same face weight appears in both nodes it joins.
+void FdtdSolver::updateCoefficients() {
+  auto tension = [this](double r, double theta) -> double {
+    return m_tension ? m_tension(float(r / m_radius), float(theta)) : 1.0;
+  };
+  auto density = [this](double r, double theta) -> double {
+    return m_density ? m_density(float(r / m_radius), float(theta)) : 1.0;
+  };
+  const int size = m_rows * m_stride;
+  m_outer.fill(0.0f, size);
+  m_inner.fill(0.0f, size);
+  m_next.fill(0.0f, size);
+  m_previous.fill(0.0f, size);
+  const double c2 = double(m_wave_speed) * m_wave_speed;
+  const double dr2 = m_dr * m_dr;
+  const double dtheta2 = m_dtheta * m_dtheta;
+  double lambda = 0.0;
+
+  // Centre: 4 / dr^2 times the mean over the first ring.
+  const double centreDensity = density(0.0, 0.0);
+  double centreSum = 0.0;
+  for (int k(0); k < m_angles; k++) {
+    double theta = k * m_dtheta;
+    double coupling = 4 * c2 * tension(0.5 * m_dr, theta) /
+                      (centreDensity * dr2 * m_angles);
+    m_outer[k + 1] = float(coupling);
+    centreSum += coupling;
+  }
+  lambda = 2 * centreSum;
+
+  for (int i = 1; i < m_rows - 1; i++) {
+    const double r = i * m_dr;
+    for (int k(0); k < m_angles; k++) {
+      const double theta = k * m_dtheta;
+      const double scale = c2 / density(r, theta);
+      const double outer = (r + 0.5 * m_dr) * tension(r + 0.5 * m_dr, theta) /
+                           (r * dr2) * scale;
+      const double inner = (r - 0.5 * m_dr) * tension(r - 0.5 * m_dr, theta) /
+                           (r * dr2) * scale;
+      const double next =
+          tension(r, theta + 0.5 * m_dtheta) / (r * r * dtheta2) * scale;
+      const double previous =
+          tension(r, theta - 0.5 * m_dtheta) / (r * r * dtheta2) * scale;
+      const int index = i * m_stride + k + 1;
+      m_outer[index] = float(outer);
+      m_inner[index] = float(inner);
+      m_next[index] = float(next);
+      m_previous[index] = float(previous);
+      lambda = qMax(lambda, 2 * (outer + inner + next + previous));
+    }
+  }
+  m_maxStep = courantSafety * 2 / std::sqrt(lambda);
+  setTimeStep(m_maxStep);
+}
+
+// A new step keeps the velocity (u - u_last) / dt of the current state.
+void FdtdSolver::setTimeStep(double dt) {
+  if (m_dt > 0.0 && dt != m_dt) {
+    const float ratio = float(dt / m_dt);
+    for (int i(0); i < m_last.size(); i++)
+      m_last[i] = m_current[i] - (m_current[i] - m_last[i]) * ratio;
+  }
+  m_dt = dt;
+  const double g = 0.5 * m_damping * dt;
+  m_c0 = float(2 / (1 + g));
+  m_c1 = float((1 - g) / (1 + g));
+  m_c2 = float(dt * dt / (1 + g));
+}
+
+void FdtdSolver::setState(const float* displacement, const float* velocity) {
+  for (int i(0); i < m_rows; i++) {
+    float* current = row(m_current, i);
+    float* last = row(m_last, i);
+    for (int k(0); k < m_angles; k++) {
+      const int index = i * m_columns + k;
+      current[k + 1] = displacement[index];
+      last[k + 1] = displacement[index] -
+                    float(m_dt) * (velocity ? velocity[index] : 0.0f);
+    }
+  }
+  // One centre value, a clamped rim.
+  for (QVector<float>* buffer : {&m_current, &m_last}) {
+    float* centre = row(*buffer, 0);
+    double sum = 0.0;
+    for (int k(1); k <= m_angles; k++) sum += centre[k];
+    for (int k(0); k < m_stride; k++) centre[k] = float(sum / m_angles);
+    float* rim = row(*buffer, m_rows - 1);
+    for (int k(0); k < m_stride; k++) rim[k] = 0.0f;
+    for (int i(1); i < m_rows - 1; i++) {
+      float* u = row(*buffer, i);
+      u[0] = u[m_angles];
+      u[m_angles + 1] = u[1];
+    }
+  }
+  m_time = 0.0;
+  m_pending = 0.0;
+  m_steps = 0;
+}
+
+void FdtdSolver::setModeField(const ModeField& mode_field) {
+  if (mode_field.isEmpty()) return;
+  const int n = int(mode_field.besselOrder());
+  QVector<double> arguments(m_rows);
+  QVector<double> radial(m_rows);
+  for (int i(0); i < m_rows; i++)
+    arguments[i] = mode_field.besselRoot() * qMin(1.0, i * m_dr / m_radius);
+  bessel::cyl_bessel_j(n, arguments.constData(), radial.data(), m_rows);
+  m_mode.resize(m_rows * m_columns);
+  for (int i(0); i < m_rows; i++)
+    for (int k(0); k < m_columns; k++)
+      m_mode[i * m_columns + k] = float(
+          radial[i] * std::cos(mode_field.besselOrder() * k * m_dtheta));
+  setState(m_mode.constData(), 0);
+}
+
+void FdtdSolver::strike(const StrikeCondition& strike) {
+  QVector<float> profile(m_rows * m_columns);
+  const double x0 = strike.position * std::cos(strike.angle);
+  const double y0 = strike.position * std::sin(strike.angle);
+  const double width2 = double(strike.width) * strike.width;
+  for (int i(0); i < m_rows; i++) {
+    const double rho = i * m_dr / m_radius;
+    for (int k(0); k < m_columns; k++) {
+      const double dx = rho * std::cos(k * m_dtheta) - x0;
+      const double dy = rho * std::sin(k * m_dtheta) - y0;
+      profile[i * m_columns + k] =
+          float(std::exp(-(dx * dx + dy * dy) / (2 * width2)));
+    }
+  }
+  if (strike.excitation == StrikeCondition::Pluck) {
+    setState(profile.constData(), 0);
+  } else {
+    // Velocity peak w(0, 1): a mallet as wide as the drum would swing the
+    // membrane by about 1.
+    const double omega = m_wave_speed * 2.404825557695773 / m_radius;
+    for (float& value : profile) value *= float(omega);
+    QVector<float> rest(m_rows * m_columns, 0.0f);
+    setState(rest.constData(), profile.constData());
+  }
+}
+
+int FdtdSolver::advance(double duration) {
+  m_pending += duration;
+  int steps = int(m_pending / m_dt);
+  if (steps > maxStepsPerAdvance) {
+    steps = maxStepsPerAdvance;
+    m_pending = steps * m_dt;
+  }
+  QElapsedTimer clock;
+  clock.start();
+  int done = 0;
+  while (done < steps) {
+    step();
+    done++;
+    if (clock.elapsed() >= maxAdvanceTime) break;
+  }
+  m_pending = done < steps ? 0.0 : m_pending - steps * m_dt;
+  return done;
+}
+
+// New values overwrite m_last, which then becomes the current state.
+void FdtdSolver::step() {
+  MetricsTimer timer(Metrics::FdtdStep);
+  stepCentre();
+  const int interior = m_rows - 2;
+  if (m_rows * m_angles >= parallelNodes && m_threadPool->maxThreadCount() > 1) {
+    const int bands = m_threadPool->maxThreadCount();
+    parallelFor(m_threadPool, bands, [this, bands, interior](int b) {
+      stepRows(1 + b * interior / bands, 1 + (b + 1) * interior / bands);
+    });
+  } else {
+    stepRows(1, m_rows - 1);
+  }
+  std::swap(m_current, m_last);
+  m_time += m_dt;
+  m_steps++;
+}
+
+void FdtdSolver::stepCentre() {
+  const float* centre = row(m_current, 0);
+  const float* ring = row(m_current, 1);
+  const float* coupling = row(m_outer, 0);
+  const float u = centre[1];
+  double laplacian = 0.0;
+  for (int k(1); k <= m_angles; k++) laplacian += coupling[k] * (ring[k] - u);
+  float* out = row(m_last, 0);
+  const float value = m_c0 * u - m_c1 * out[1] + m_c2 * float(laplacian);
+  for (int k(0); k < m_stride; k++) out[k] = value;
+}
+
+// Rows [first, last) in column tiles, so that the three input rows of a
+// tile are still cached when the next row reuses two of them.
+void FdtdSolver::stepRows(int first, int last) {
+  for (int tile = 1; tile <= m_angles; tile += tileColumns) {
+    const int end = qMin(m_angles + 1, tile + tileColumns);
+    for (int i = first; i < last; i++) {
+      const float* u = row(m_current, i);
+      const float* outer = row(m_current, i + 1);
+      const float* inner = row(m_current, i - 1);
+      const float* wOuter = row(m_outer, i);
+      const float* wInner = row(m_inner, i);
+      const float* wNext = row(m_next, i);
+      const float* wPrevious = row(m_previous, i);
+      float* out = row(m_last, i);
+      int k = tile;
+#if defined(__SSE2__)
+      const __m128 c0 = _mm_set1_ps(m_c0);
+      const __m128 c1 = _mm_set1_ps(m_c1);
+      const __m128 c2 = _mm_set1_ps(m_c2);
+      for (; k + 4 <= end; k += 4) {
+        __m128 centre = _mm_loadu_ps(u + k);
+        __m128 laplacian = _mm_add_ps(
+            _mm_add_ps(
+                _mm_mul_ps(_mm_loadu_ps(wOuter + k),
+                           _mm_sub_ps(_mm_loadu_ps(outer + k), centre)),
+                _mm_mul_ps(_mm_loadu_ps(wInner + k),
+                           _mm_sub_ps(_mm_loadu_ps(inner + k), centre))),
+            _mm_add_ps(
+                _mm_mul_ps(_mm_loadu_ps(wNext + k),
+                           _mm_sub_ps(_mm_loadu_ps(u + k + 1), centre)),
+                _mm_mul_ps(_mm_loadu_ps(wPrevious + k),
+                           _mm_sub_ps(_mm_loadu_ps(u + k - 1), centre))));
+        __m128 value = _mm_add_ps(
+            _mm_sub_ps(_mm_mul_ps(c0, centre),
+                       _mm_mul_ps(c1, _mm_loadu_ps(out + k))),
+            _mm_mul_ps(c2, laplacian));
+        _mm_storeu_ps(out + k, value);
+      }
+#endif
+      for (; k < end; k++) {
+        const float centre = u[k];
+        const float laplacian = wOuter[k] * (outer[k] - centre) +
+                                wInner[k] * (inner[k] - centre) +
+                                wNext[k] * (u[k + 1] - centre) +
+                                wPrevious[k] * (u[k - 1] - centre);
+        out[k] = m_c0 * centre - m_c1 * out[k] + m_c2 * laplacian;
+      }
+    }
+  }
+  for (int i = first; i < last; i++) {
+    float* out = row(m_last, i);
+    out[0] = out[m_angles];
+    out[m_angles + 1] = out[1];
+  }
+}
+
+float FdtdSolver::displacement(int row, int column) const {
+  return this->row(m_current, row)[column % m_angles + 1];
+}
+
+QVector<float> FdtdSolver::radii() const {
+  QVector<float> radii(m_rows);
+  for (int i(0); i < m_rows; i++) radii[i] = qMin(m_radius, float(i * m_dr));
+  return radii;
+}
+
+QVector<float> FdtdSolver::thetas() const {
+  QVector<float> thetas(m_columns);
+  for (int k(0); k < m_columns; k++)
+    thetas[k] = qMin(float(2 * M_PI), float(k * m_dtheta));
+  return thetas;
+}
+
+float FdtdSolver::deviation(float temporal) const {
+  if (m_mode.isEmpty()) return 0.0f;
+  float deviation = 0.0f;
+  for (int i(0); i < m_rows; i++)
+    for (int k(0); k < m_columns; k++)
+      deviation = qMax(deviation,
+                       std::fabs(displacement(i, k) -
+                                 m_mode[i * m_columns + k] * temporal));
+  return deviation;
+}
+
+QSurfaceDataArray* FdtdSolver::newSurfaceDataArray() const {
+  auto newArray = new QSurfaceDataArray();
+  newArray->reserve(m_rows);
+  for (int i(0); i < m_rows; i++) {
+    QSurfaceDataRow* newRow = new QSurfaceDataRow(m_columns);
+    const float r = qMin(m_radius, float(i * m_dr));
+    for (int k(0); k < m_columns; k++)
+      (*newRow)[k].setPosition(
+          QVector3D(qMin(float(2 * M_PI), float(k * m_dtheta)),
+                    displacement(i, k), r));
+    newArray->append(newRow);
+  }
+  return newArray;
+}
+
+void FdtdSolver::updateSurfaceDataArray(QSurfaceDataArray& array) const {
+  for (int i(0); i < m_rows; i++) {
+    QSurfaceDataItem* items = array[i]->data();
+    const float* u = row(m_current, i);
+    for (int k(0); k < m_angles; k++) items[k].setY(u[k + 1]);
+    items[m_angles].setY(u[1]);
+  }
+}
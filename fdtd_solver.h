@@ -0,0 +1,144 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  FdtdSolver Class.
+  Finite difference time domain solver for non-ideal membranes.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef FDTDSOLVER_H
+#define FDTDSOLVER_H
+
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+#include <QtDataVisualization/QSurface3DSeries>
+#include <functional>
+#include "mode_field.h"
+#include "superposition.h"
+
+using namespace QtDataVisualization;
+
+// Explicit finite difference time domain solver of the damped membrane
+//   rho u_tt = div(T grad u) - gamma rho u_t,  u = 0 at r = R,
+// on the polar grid Solution samples: rows r_i = i dr from the centre to
+// the rim, columns theta_k = k dtheta over [0, 2 pi], the last column
+// repeating the first. Tension T and density rho are relative profiles of
+// (r / R, theta), an empty profile meaning 1 everywhere, so c^2 T / rho is
+// the local squared wave speed.
+// The flux form stencil keeps energy balanced for any profile; the centre
+// is one node with the Cartesian five point Laplacian averaged over the
+// first ring. Leapfrog time stepping is stable for dt^2 lambda <= 4, with
+// lambda bounded per node by Gershgorin, and dt is rederived from that
+// bound whenever the medium changes. Displacement is stored in two
+// buffers with a ghost column on each side, so the periodic theta
+// neighbours need no wrap in the kernel.
+class FdtdSolver {
+ public:
+  typedef std::function<float(float rho, float theta)> Profile;
+
+  const static double courantSafety;
+  const static int tileColumns;
+  const static int parallelNodes;
+  const static int maxStepsPerAdvance;
+  const static qint64 maxAdvanceTime;
+
+  FdtdSolver(int sampleCount, float radius, float wave_speed);
+  ~FdtdSolver();
+  int rowCount() const;
+  int columnCount() const;
+  void setThreadCount(int count);
+  void setTension(Profile tension);
+  void setDensity(Profile density);
+  void setDamping(double damping);
+  double damping() const;
+  double timeStep() const;
+  double time() const;
+  qint64 stepCount() const;
+  bool isIdeal() const;
+
+  // Displacement and velocity on the display grid, rowCount x columnCount,
+  // row major; velocity may be null for a membrane at rest.
+  void setState(const float* displacement, const float* velocity);
+  // The mode shape at temporal factor 1, released from rest. The mode is
+  // evaluated on the solver grid, whatever grid mode_field samples.
+  void setModeField(const ModeField& mode_field);
+  // A Gaussian mallet of peak 1, as velocity (strike) or displacement.
+  void strike(const StrikeCondition& strike);
+
+  // Runs the whole steps that fit in duration; the remainder carries over
+  // to the next call. At most maxStepsPerAdvance steps, or maxAdvanceTime
+  // ms of stepping, run per call, and time that would need more is
+  // dropped, so a slow machine shows the membrane in slow motion rather
+  // than freezing.
+  int advance(double duration);
+  void step();
+
+  float displacement(int row, int column) const;
+  // Positions of the rows and columns, as in the surface arrays.
+  QVector<float> radii() const;
+  QVector<float> thetas() const;
+  // Largest |u - mode * cos(w t)| over the grid: the deviation from the
+  // analytic Solution of the mode last set by setModeField.
+  float deviation(float temporal) const;
+  QSurfaceDataArray* newSurfaceDataArray() const;
+  void updateSurfaceDataArray(QSurfaceDataArray& array) const;
+
+ private:
+  void updateCoefficients();
+  void setTimeStep(double dt);
+  void stepRows(int first, int last);
+  void stepCentre();
+  float* row(QVector<float>& buffer, int i);
+  const float* row(const QVector<float>& buffer, int i) const;
+
+  int m_rows;
+  int m_columns;
+  int m_angles;
+  int m_stride;
+  float m_radius;
+  float m_wave_speed;
+  double m_dr;
+  double m_dtheta;
+  Profile m_tension;
+  Profile m_density;
+  double m_damping;
+  double m_maxStep;
+  double m_dt;
+  float m_c0;
+  float m_c1;
+  float m_c2;
+  double m_time;
+  double m_pending;
+  qint64 m_steps;
+  // Per node coupling to the outer, inner, next and previous neighbour,
+  // c^2 T / rho already divided by the grid spacings. Row 0 of m_outer
+  // holds the couplings of the centre to each node of the first ring.
+  QVector<float> m_outer;
+  QVector<float> m_inner;
+  QVector<float> m_next;
+  QVector<float> m_previous;
+  QVector<float> m_current;
+  QVector<float> m_last;
+  QVector<float> m_mode;
+  QThreadPool* m_threadPool;
+};
+
+#endif
@@ -23,13 +23,29 @@
 
  **/
 
+#include "adaptive_grid.h"
+#include "batch_cli.h"
 #include "membrane.h"
+#include <QtCore/QStandardPaths>
 #include <QtWidgets/QApplication>
 
 int main(int argc, char **argv)
 {
+    if (batch_cli::isRequested(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        return batch_cli::run(app);
+    }
     QApplication app(argc, argv);
-    Solution* solution= new Solution(200, 50, 20.0f, 200);
+    QString cacheDirectory =
+        QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    Solution* solution= new Solution(200, 20.0f, 200, cacheDirectory, false);
+    if (!app.arguments().contains("--uniform"))
+        solution->setSamplingTolerance(AdaptiveGrid::defaultTolerance);
+    solution->generateData(0.0, 1);
     Membrane  membrane{solution};
+    if (app.arguments().contains("--shader"))
+        membrane.setRenderer(Membrane::ShaderRenderer);
+    if (app.arguments().contains("--serve"))
+        membrane.serveQueries(QueryServer::defaultName);
     return app.exec();
 }
@@ -26,8 +26,11 @@
 
 #include "membrane.h"
 
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtCore/qmath.h>
+#include <cmath>
 #include <QTimer>
+#include <QtDataVisualization/Q3DCamera>
 #include <QtDataVisualization/Q3DTheme>
 #include <QtDataVisualization/QValue3DAxis>
 #include <QtMath>
@@ -37,7 +40,9 @@
 #include <QtGui/QPainter>
 #include <QtGui/QScreen>
 #include <QtWidgets/QApplication>
+#include <QtWidgets/QCheckBox>
 #include <QtWidgets/QComboBox>
+#include <QtWidgets/QFileDialog>
 #include <QtWidgets/QGroupBox>
 #include <QtWidgets/QHBoxLayout>
 #include <QtWidgets/QLabel>
@@ -51,29 +56,75 @@
 #include <QtWidgets/QDoubleSpinBox>
 #include <QtWidgets/QSpinBox>
 #include <QtWidgets/QLabel>
+#include "bessel_zeros.h"
+#include "metrics.h"
+#include "metrics_panel.h"
+#include "spectrum_panel.h"
 
 using namespace QtDataVisualization;
 using namespace qt_helpers;
 
+const double Membrane::defaultPlaybackSpeed = 0.1;
+// Vertices further apart than this on screen are worth refining for.
+const int Membrane::pixelsPerSample = 4;
+// Resizes and zooms come in bursts; refine once they settle.
+const int Membrane::detailDelay = 200;
+// A mode loops over one period; a strike is exported as eight seconds of
+// what the view shows, at the playback speed.
+const int Membrane::meshSlices = 48;
+const int Membrane::meshFrames = 240;
+// Traced nodal lines of a moving field follow it a few times a second;
+// repainting the texture every frame would cost more than the frame.
+const int Membrane::nodalInterval = 200;
+
 Membrane::Membrane(Solution* solution)
     : m_graph(new Q3DSurface()),
       m_membraneProxy(new QSurfaceDataProxy()),
       m_solution(solution),
+      m_generator(new ModeGenerator(solution, this)),
       m_resetArray(0),
+      m_modeStride(1),
+      m_detailTimer(new QTimer(this)),
       m_selected_bessel_order{0.0f},
-      m_selected_bessel_root{1}
+      m_selected_bessel_root{1},
+      m_renderer(SurfaceRenderer),
+      m_frameTimer(new QTimer(this)),
+      m_animationTime(0.0),
+      m_playbackSpeed(defaultPlaybackSpeed),
+      m_superpositionTime(0.0),
+      m_fdtd(0),
+      m_fdtdFromMode(false),
+      m_queryServer(0),
+      m_nodalOverlay(QImage(":/maps/drumhead")),
+      m_nodalLinesVisible(false),
+      m_nodalPending(false),
+      m_cavityView(0)
+#ifdef DRUM_AUDIO_OUTPUT
+      , m_audio(new DrumAudio(this))
+#endif
 {
+  // The solution starts out with mode (0, 1) already generated.
+  Metrics::setGauge(Metrics::ModeFieldBytes,
+                    m_solution->modeField().byteSize());
+  m_nodalPool.setMaxThreadCount(1);
   setUpUi();
   initializeGraph();
   initializeSeries();
-  activateNormalMode();
 
-  QTimer *timer = new QTimer(this);
-  connect(timer, SIGNAL(timeout()), this, SLOT(updateTimeSlice()));
-  timer->start(50);
+  // One frame per display refresh. Timer ticks missed while a frame is
+  // late are not queued up, and the next frame picks up the current phase.
+  m_frameTimer->setTimerType(Qt::PreciseTimer);
+  connect(m_frameTimer, SIGNAL(timeout()), this, SLOT(updateFrame()));
+  m_frameTimer->start(frameInterval());
 }
 
+// The query server goes first: its requests use the solution.
 Membrane::~Membrane() {
+  m_nodalWatcher.waitForFinished();
+  delete m_cavityView;
+  delete m_queryServer;
+  delete m_fdtd;
+  delete m_generator;
   delete m_membraneSeries;
   delete m_graph;
   delete m_solution;
@@ -103,19 +154,133 @@ void Membrane::initializeGraph() {
   m_graph->axisX()->setLabelAutoRotation(30);
   m_graph->axisY()->setLabelAutoRotation(90);
   m_graph->axisZ()->setLabelAutoRotation(30);
+
+  m_detailTimer->setSingleShot(true);
+  m_detailTimer->setInterval(detailDelay);
+  connect(m_detailTimer, SIGNAL(timeout()), this, SLOT(updateDetail()));
+  connect(m_graph, SIGNAL(widthChanged(int)), m_detailTimer, SLOT(start()));
+  connect(m_graph, SIGNAL(heightChanged(int)), m_detailTimer, SLOT(start()));
+  connect(m_graph->scene()->activeCamera(), SIGNAL(zoomLevelChanged(float)),
+          m_detailTimer, SLOT(start()));
+}
+
+// At 100% zoom the membrane spans about the shorter side of the graph.
+// The rim is about pi times that diameter long and the radius half of it.
+// A graph not laid out yet asks for the complete field.
+QSize Membrane::visibleDetail() const {
+  const qreal zoom = m_graph->scene()->activeCamera()->zoomLevel() / 100.0;
+  const qreal diameter = qMin(m_graph->width(), m_graph->height()) *
+                         m_graph->devicePixelRatio() * zoom;
+  if (diameter <= 0.0) return QSize();
+  return QSize(qCeil(M_PI * diameter / pixelsPerSample),
+               qCeil(diameter / 2 / pixelsPerSample));
+}
+
+// A field left partly refined is refined further once the view shows
+// more detail than it holds.
+void Membrane::updateDetail() {
+  if (m_modeStride <= 1 || m_generator->isBusy()) return;
+  const ModeField& mode_field = m_solution->modeField();
+  QSize detail = visibleDetail();
+  if (mode_field.columnCount() < detail.width() ||
+      mode_field.rowCount() < detail.height())
+    m_generator->refine(mode_field, m_modeStride, detail);
 }
 
 void Membrane::changeTheme(int theme) {
   m_graph->activeTheme()->setType(Q3DTheme::Theme(theme));
 }
 
-void Membrane::updateTimeSlice() {
-  m_timeSliceIndex++;
-  if (m_timeSliceIndex > m_solution->getTimeSlices().size() - 1)
-    m_timeSliceIndex = 0;
-  auto qsurface_data_array = m_solution->getTimeSlices().at(m_timeSliceIndex);
-  auto modifier = [](QSurfaceDataItem item) -> void { item.position(); };
-  m_membraneProxy->resetArray(newSurfaceDataArrayFromSource(qsurface_data_array, modifier));
+int Membrane::frameInterval() const {
+  qreal refreshRate = m_graph->screen()->refreshRate();
+  return refreshRate > 0 ? qMax(1, qRound(1000.0 / refreshRate)) : 16;
+}
+
+// Animation time advances by the wall clock time since the previous frame
+// scaled by the playback speed, so motion keeps its speed whatever the
+// frame rate and dropped frames only lower the smoothness. It is kept
+// within one period of the current mode. A superposition is not periodic,
+// so its time just keeps running from the strike, and the finite
+// difference solver steps through the same scaled time.
+void Membrane::updateFrame() {
+  MetricsTimer timer(Metrics::FrameUpdate);
+  qint64 elapsed = m_frameClock.isValid() ? m_frameClock.nsecsElapsed() : 0;
+  m_frameClock.start();
+  if (elapsed && Metrics::isEnabled())
+    Metrics::record(Metrics::FrameInterval, elapsed);
+  if (m_fdtd) {
+    int steps = m_fdtd->advance(1e-9 * elapsed * m_playbackSpeed);
+    if (!m_resetArray) {
+      m_resetArray = m_fdtd->newSurfaceDataArray();
+      Metrics::setGauge(Metrics::SurfaceArrayBytes,
+                        surfaceDataArrayBytes(*m_resetArray));
+    } else
+      m_fdtd->updateSurfaceDataArray(*m_resetArray);
+    m_membraneProxy->resetArray(m_resetArray);
+    if (!m_fdtdStatusClock.isValid() ||
+        m_fdtdStatusClock.elapsed() >= MetricsPanel::refreshInterval) {
+      m_fdtdStatusClock.start();
+      bool reference = m_fdtdFromMode && m_fdtd->isIdeal();
+      m_fdtdPanel->setStatus(
+          m_fdtd->timeStep(), steps,
+          reference ? m_fdtd->deviation(m_solution->temporalAt(m_fdtd->time()))
+                    : -1.0f);
+    }
+    if (m_nodalLinesVisible && m_nodalClock.elapsed() >= nodalInterval)
+      updateNodalLines();
+    return;
+  }
+  if (!m_superposition.isEmpty()) {
+    m_superpositionTime += 1e-9 * elapsed * m_playbackSpeed;
+    if (!m_resetArray) {
+      m_resetArray = m_superposition.newSurfaceDataArray(m_superpositionTime);
+      Metrics::setGauge(Metrics::SurfaceArrayBytes,
+                        surfaceDataArrayBytes(*m_resetArray));
+    } else
+      m_superposition.updateSurfaceDataArray(m_superpositionTime,
+                                             *m_resetArray);
+    m_membraneProxy->resetArray(m_resetArray);
+    if (m_nodalLinesVisible && m_nodalClock.elapsed() >= nodalInterval)
+      updateNodalLines();
+    return;
+  }
+  m_animationTime = std::fmod(m_animationTime + 1e-9 * elapsed * m_playbackSpeed,
+                              m_solution->period());
+  const ModeField& mode_field = m_solution->modeField();
+  float temporal = m_solution->temporalAt(m_animationTime);
+  if (m_renderer == ShaderRenderer) {
+    m_shaderView->setTemporal(temporal);
+    return;
+  }
+  // The proxy owns m_resetArray; resetting it with the same array only
+  // signals the change, so steady state frames allocate nothing.
+  if (!m_resetArray) {
+    m_resetArray = mode_field.newSurfaceDataArray(temporal);
+    Metrics::setGauge(Metrics::SurfaceArrayBytes,
+                      surfaceDataArrayBytes(*m_resetArray));
+  } else
+    mode_field.updateSurfaceDataArray(temporal, *m_resetArray);
+  m_membraneProxy->resetArray(m_resetArray);
+}
+
+void Membrane::setPlaybackSpeed(double speed) {
+  m_playbackSpeed = speed;
+}
+
+// The views share the animation clock; only the visible one is fed frames.
+// The shader view only knows single modes, so it drops a superposition.
+void Membrane::setRenderer(int renderer) {
+  if (renderer == ShaderRenderer) m_fdtdPanel->setChecked(false);
+  if (renderer == ShaderRenderer && !m_superposition.isEmpty()) {
+    m_superposition = Superposition();
+    m_resetArray = 0;
+    setModeLabel();
+    updateQuerySource();
+    updateNodalLines();
+  }
+  m_renderer = renderer;
+  m_views->setCurrentIndex(renderer);
+  m_rendererList->setCurrentIndex(renderer);
 }
 
 void Membrane::setSelectedBesselOrder( int n) {
@@ -126,19 +291,281 @@ void Membrane::setSelectedBesselRoot(int m) {
   m_selected_bessel_root = m;
 }
 
+// From the spectrum table: the spinboxes, and through them the selection,
+// follow, then the mode is generated as if reset by hand.
+void Membrane::activateMode(int n, int m) {
+  m_besselOrderSbx->setValue(n);
+  m_besselRootSbx->setValue(m);
+  activateNormalMode();
+}
+
+// The mode is generated in the background; the current one keeps
+// animating until installModeField swaps the new one in, coarse at first
+// and then at each finer level up to what the view can show.
 void Membrane::activateNormalMode() {
-  m_solution->generateData(m_selected_bessel_order, m_selected_bessel_root);
+  m_generationProgress->setValue(0);
+  m_generator->request(m_selected_bessel_order, m_selected_bessel_root,
+                       visibleDetail());
+}
+
+void Membrane::installModeField(const ModeField& mode_field, int stride) {
+  const ModeField& current = m_solution->modeField();
+  const bool sameMode = mode_field.besselOrder() == current.besselOrder() &&
+                        mode_field.rootOrder() == current.rootOrder();
+  // A new grid needs a new frame array, the proxy deletes the old one.
+  if (!m_superposition.isEmpty() ||
+      !mode_field.sameGrid(m_solution->modeField()))
+    m_resetArray = 0;
+  m_superposition = Superposition();
+  m_solution->setModeField(mode_field);
+  m_modeStride = stride;
+  if (m_fdtd && !sameMode) restartFdtd();
+  Metrics::setGauge(Metrics::ModeFieldBytes, mode_field.byteSize());
+  m_shaderView->setModeField(mode_field);
+  setModeLabel();
+  updateQuerySource();
+  updateNodalLines();
+  if (m_generator->isBusy()) return;
+  m_generationProgress->setValue(100);
+  m_generator->prefetchNeighbors(mode_field.besselOrder(),
+                                 mode_field.rootOrder());
+}
+
+bool Membrane::serveQueries(const QString& name) {
+  if (!m_queryServer) m_queryServer = new QueryServer(m_solution, this);
+  updateQuerySource();
+  if (m_queryServer->listen(name)) return true;
+  qWarning("Cannot serve queries on %s: %s", qPrintable(name),
+           qPrintable(m_queryServer->errorString()));
+  return false;
+}
+
+// Queries follow the analytic source on display; the finite difference
+// solution is not queryable.
+void Membrane::updateQuerySource() {
+  if (!m_queryServer) return;
+  m_queryServer->setModes(m_superposition.isEmpty()
+                              ? QVector<Superposition::Mode>()
+                                    << m_solution->currentMode()
+                              : m_superposition.modes());
+}
+
+void Membrane::strike(const StrikeCondition& strike, int modeCount) {
+  if (m_fdtd) {
+    m_fdtd->strike(strike);
+    m_fdtdFromMode = false;
+    return;
+  }
+  m_generationProgress->setValue(0);
+  m_generator->requestSuperposition(strike, modeCount);
+}
+
+// Superpositions are drawn on the Data Visualization surface, on the
+// uniform grid of the Solution, which an adaptive mode grid does not share.
+void Membrane::installSuperposition(const Superposition& superposition) {
+  if (superposition.rowCount() != m_superposition.rowCount() ||
+      superposition.columnCount() != m_superposition.columnCount())
+    m_resetArray = 0;
+  m_superposition = superposition;
+  m_superpositionTime = 0.0;
+  setRenderer(SurfaceRenderer);
+  m_generationProgress->setValue(100);
+  setModeLabel();
+  updateQuerySource();
+  updateNodalLines();
+#ifdef DRUM_AUDIO_OUTPUT
+  if (m_strikePanel->isSoundEnabled() && m_audio->start())
+    m_audio->play(new DrumSynth(
+        DrumSynth::partials(superposition.modes(),
+                            m_strikePanel->fundamental(),
+                            m_strikePanel->decayTime()),
+        DrumSynth::defaultSampleRate));
+#endif
+}
+
+// The sound of the current strike, until the fundamental has decayed.
+void Membrane::exportWav(const QString& fileName) {
+  if (m_superposition.isEmpty()) {
+    qWarning("Strike the drum before exporting its sound");
+    return;
+  }
+  const QVector<DrumSynth::Partial> partials =
+      DrumSynth::partials(m_superposition.modes(),
+                          m_strikePanel->fundamental(),
+                          m_strikePanel->decayTime());
+  const double seconds = m_strikePanel->decayTime() + 0.5;
+  m_generationProgress->setValue(0);
+  m_generator->requestExport(
+      fileName, [partials, seconds, fileName](ProgressCallback progress) {
+    DrumSynth synth(partials, DrumSynth::defaultSampleRate);
+    return synth.writeWav(fileName, seconds, progress);
+  });
+}
+
+// Exports the analytic source on display, the current mode or strike.
+void Membrane::exportMesh() {
+  QString fileName = QFileDialog::getSaveFileName(
+      0, QStringLiteral("Export Mesh"), QString(),
+      QStringLiteral("glTF (*.gltf);;PLY sequence (*.ply)"));
+  if (fileName.isEmpty()) return;
+  QVector<Superposition::Mode> modes;
+  if (m_superposition.isEmpty()) modes << m_solution->currentMode();
+  else modes = m_superposition.modes();
+  MeshExport mesh(modes, m_solution->radius());
+  if (m_superposition.isEmpty())
+    mesh.setFrames(0.0, m_solution->period() / meshSlices, meshSlices);
+  else
+    mesh.setFrames(0.0, m_playbackSpeed / MeshExport::defaultFrameRate,
+                   meshFrames);
+  m_generationProgress->setValue(0);
+  m_generator->requestExport(fileName,
+                             [mesh, fileName](ProgressCallback progress) {
+    return mesh.write(fileName, progress);
+  });
+}
+
+void Membrane::finishExport(const QString& fileName, bool ok) {
+  if (!ok) qWarning("Cannot write %s", qPrintable(fileName));
+  if (!m_generator->isBusy()) m_generationProgress->setValue(100);
+}
+
+void Membrane::setNodalLinesVisible(bool visible) {
+  m_nodalLinesVisible = visible;
+  if (visible) {
+    updateNodalLines();
+    return;
+  }
+  m_membraneSeries->setTexture(QImage(":/maps/drumhead"));
+  m_shaderView->setNodalLines(QVector<NodalLines::Polyline>(), 0.0f,
+                              NodalOverlay::lineColor);
+}
+
+// A single mode shows its exact nodal set, on both views. A strike or the
+// finite difference solution is traced on its own grid as it is now; the
+// shader view never shows those. Tracing and painting run on a worker, one
+// overlay at a time; a call meanwhile is served once it is installed.
+void Membrane::updateNodalLines() {
+  if (!m_nodalLinesVisible) return;
+  m_nodalClock.start();
+  if (m_nodalWatcher.isRunning()) {
+    m_nodalPending = true;
+    return;
+  }
+  m_nodalPending = false;
+  QVector<float> radii, thetas, values;
+  Superposition superposition;
+  if (m_fdtd) {
+    radii = m_fdtd->radii();
+    thetas = m_fdtd->thetas();
+    values.resize(radii.size() * thetas.size());
+    for (int i(0); i < radii.size(); i++)
+      for (int k(0); k < thetas.size(); k++)
+        values[i * thetas.size() + k] = m_fdtd->displacement(i, k);
+  } else if (!m_superposition.isEmpty()) {
+    superposition = m_superposition;
+    radii = superposition.radii();
+    thetas = superposition.thetas();
+  } else {
+    const ModeField& mode_field = m_solution->modeField();
+    QVector<NodalLines::Polyline> lines =
+        NodalLines::mode(mode_field.besselOrder(), mode_field.rootOrder(),
+                         m_solution->radius());
+    m_shaderView->setNodalLines(lines, m_solution->radius(),
+                                NodalOverlay::lineColor);
+    m_nodalWatcher.setFuture(
+        QtConcurrent::run(&m_nodalPool, [this, lines, mode_field]() {
+      return m_nodalOverlay.paint(lines, mode_field.radii(),
+                                  mode_field.rowCount(), mode_field.thetas(),
+                                  mode_field.columnCount());
+    }));
+    return;
+  }
+  const double time = m_superpositionTime;
+  QThreadPool* pool = m_solution->threadPool();
+  m_nodalWatcher.setFuture(QtConcurrent::run(&m_nodalPool, [=]() mutable {
+    if (!superposition.isEmpty()) {
+      values.resize(radii.size() * thetas.size());
+      superposition.evaluate(time, values.data());
+    }
+    QVector<NodalLines::Polyline> lines = NodalLines::contour(
+        values.constData(), radii.constData(), radii.size(),
+        thetas.constData(), thetas.size(), pool);
+    return m_nodalOverlay.paint(lines, radii.constData(), radii.size(),
+                                thetas.constData(), thetas.size());
+  }));
+}
+
+// Only the texture upload is left to the GUI thread.
+void Membrane::installNodalOverlay() {
+  if (m_nodalLinesVisible)
+    m_membraneSeries->setTexture(m_nodalWatcher.result());
+  if (m_nodalPending) updateNodalLines();
+}
+
+// A separate window, created on first use; it generates its first volume
+// as it opens.
+void Membrane::showCavityView() {
+  if (!m_cavityView) m_cavityView = new CavityView(m_solution->radius());
+  m_cavityView->show();
+  m_cavityView->raise();
+  m_cavityView->activateWindow();
+}
+
+// The solver runs on the uniform grid of the Solution, which need not be
+// the grid of the current mode, and starts from the current mode.
+void Membrane::setFdtdEnabled(bool enabled) {
+  delete m_fdtd;
+  m_fdtd = 0;
+  m_resetArray = 0;
+  if (!enabled) {
+    updateNodalLines();
+    return;
+  }
+  m_fdtd = new FdtdSolver(m_solution->sampleCount(), m_solution->radius(),
+                          m_solution->waveSpeed());
+  m_fdtd->setThreadCount(m_solution->threadCount());
+  m_fdtdPanel->configure(m_fdtd);
+  m_superposition = Superposition();
   setModeLabel();
+  setRenderer(SurfaceRenderer);
+  restartFdtd();
+}
+
+// The current state carries on in the new medium.
+void Membrane::updateFdtdMedium() {
+  if (m_fdtd) m_fdtdPanel->configure(m_fdtd);
+}
+
+void Membrane::restartFdtd() {
+  if (!m_fdtd) return;
+  m_fdtd->setModeField(m_solution->modeField());
+  m_fdtdFromMode = true;
+  updateNodalLines();
+}
+
+void Membrane::setGenerationProgress(int percent) {
+  m_generationProgress->setValue(percent);
 }
 
 void Membrane::setModeLabel() {
+  if (!m_superposition.isEmpty()) {
+    const Superposition::Mode& highest =
+        m_superposition.mode(m_superposition.modeCount() - 1);
+    m_modeLabel->setText(QString("<b>Strike: %1 modes</b><br>"
+                                 "Orders n up to %2")
+                             .arg(m_superposition.modeCount())
+                             .arg(highest.bessel_order_n));
+    return;
+  }
+  float bessel_order = m_solution->modeField().besselOrder();
+  int bessel_root = m_solution->modeField().rootOrder();
   QString header = QString("<b>Mode (%1, %2)</b><br>")
-                  .arg(m_selected_bessel_order).arg(m_selected_bessel_root);
+                  .arg(bessel_order).arg(bessel_root);
   QString frequency_title = QString("<b>Frequency Ratio:</b><br>");
   QString frequency_ratio = QString("f(%1, %2) = <b>%3</b> * f(0, 1)\n")
-                  .arg(m_selected_bessel_order)
-                  .arg(m_selected_bessel_root)
-                  .arg( m_solution->frequency_ratio( m_selected_bessel_order, m_selected_bessel_root));
+                  .arg(bessel_order)
+                  .arg(bessel_root)
+                  .arg( m_solution->frequency_ratio( bessel_order, bessel_root));
   m_modeLabel->setText(header + frequency_title + frequency_ratio);
 }
 
@@ -161,7 +588,15 @@ void Membrane::setUpUi() {
   QWidget *widget = new QWidget;
   QHBoxLayout *hLayout = new QHBoxLayout(widget);
   QVBoxLayout *vLayout = new QVBoxLayout();
-  hLayout->addWidget(container, 1);
+  m_shaderView = new ShaderView(widget);
+  m_shaderView->setModeField(m_solution->modeField());
+  m_views = new QStackedWidget(widget);
+  m_views->addWidget(container);
+  m_views->addWidget(m_shaderView);
+  hLayout->addWidget(m_views, 1);
+  SpectrumPanel *spectrumPanel =
+      new SpectrumPanel(m_solution, m_generator, widget);
+  hLayout->addWidget(spectrumPanel);
   hLayout->addLayout(vLayout);
   vLayout->setAlignment(Qt::AlignTop);
 
@@ -177,20 +612,41 @@ void Membrane::setUpUi() {
   setModeLabel();
   normalModeVBox->addWidget(m_modeLabel);
 
-  QSpinBox *besselOrderSbx = new QSpinBox(widget);
-  besselOrderSbx->setRange(0, 10000);
-  besselOrderSbx->setPrefix("Bessel Function Order n:       ");
-  normalModeVBox->addWidget(besselOrderSbx);
+  m_besselOrderSbx = new QSpinBox(widget);
+  m_besselOrderSbx->setRange(0, BesselZeros::maxOrder);
+  m_besselOrderSbx->setPrefix("Bessel Function Order n:       ");
+  normalModeVBox->addWidget(m_besselOrderSbx);
 
 
-  QSpinBox *besselRootSbx = new QSpinBox(widget);
-  besselRootSbx->setRange(1, 5000);
-  besselRootSbx->setPrefix("Bessel Root m:                         ");
-  normalModeVBox->addWidget(besselRootSbx);
+  m_besselRootSbx = new QSpinBox(widget);
+  m_besselRootSbx->setRange(1, BesselZeros::maxRoot);
+  m_besselRootSbx->setPrefix("Bessel Root m:                         ");
+  normalModeVBox->addWidget(m_besselRootSbx);
 
   QPushButton *normalModeResetB = new QPushButton("&Reset Normal Mode", widget);
   normalModeVBox->addWidget(normalModeResetB);
 
+  QPushButton *meshExportB = new QPushButton("Export &Mesh...", widget);
+  normalModeVBox->addWidget(meshExportB);
+
+  QCheckBox *nodalLinesCb = new QCheckBox("Show &Nodal Lines", widget);
+  normalModeVBox->addWidget(nodalLinesCb);
+
+  m_generationProgress = new QProgressBar(widget);
+  m_generationProgress->setRange(0, 100);
+  m_generationProgress->setValue(100);
+  normalModeVBox->addWidget(m_generationProgress);
+
+  // Fraction of real time; at 1 the membrane moves at its physical frequency.
+  QDoubleSpinBox *playbackSpeedSbx = new QDoubleSpinBox(widget);
+  playbackSpeedSbx->setRange(0.001, 10.0);
+  playbackSpeedSbx->setDecimals(3);
+  playbackSpeedSbx->setSingleStep(0.01);
+  playbackSpeedSbx->setValue(m_playbackSpeed);
+  playbackSpeedSbx->setPrefix("Playback Speed:    ");
+  playbackSpeedSbx->setSuffix(" x");
+  normalModeVBox->addWidget(playbackSpeedSbx);
+
   normalModeGroupBox->setLayout(normalModeVBox);
 
   // Selection
@@ -233,18 +689,61 @@ void Membrane::setUpUi() {
   themeList->addItem(QStringLiteral("Isabelle"));
 
   vLayout->addWidget(normalModeGroupBox);
+  m_strikePanel = new StrikePanel(widget);
+  vLayout->addWidget(m_strikePanel);
+  m_fdtdPanel = new FdtdPanel(widget);
+  vLayout->addWidget(m_fdtdPanel);
+  QPushButton *cavityB = new QPushButton("Spherical &Cavity...", widget);
+  vLayout->addWidget(cavityB);
   vLayout->addWidget(selectionGroupBox);
   vLayout->addWidget(new QLabel(QStringLiteral("Theme")));
   vLayout->addWidget(themeList);
+
+  m_rendererList = new QComboBox(widget);
+  m_rendererList->addItem(QStringLiteral("Data Visualization"));
+  m_rendererList->addItem(QStringLiteral("Shader"));
+  vLayout->addWidget(new QLabel(QStringLiteral("Renderer")));
+  vLayout->addWidget(m_rendererList);
+  vLayout->addWidget(new MetricsPanel(frameInterval(), widget));
   widget->show();
 
   // Bindings
   QObject::connect(normalModeResetB, &QPushButton::clicked, this,
                    &Membrane::activateNormalMode);
-  QObject::connect(besselOrderSbx, SIGNAL(valueChanged(int)), this,
+  QObject::connect(meshExportB, &QPushButton::clicked, this,
+                   &Membrane::exportMesh);
+  QObject::connect(cavityB, &QPushButton::clicked, this,
+                   &Membrane::showCavityView);
+  QObject::connect(nodalLinesCb, &QCheckBox::toggled, this,
+                   &Membrane::setNodalLinesVisible);
+  QObject::connect(m_generator, &ModeGenerator::modeReady, this,
+                   &Membrane::installModeField);
+  QObject::connect(m_generator, &ModeGenerator::superpositionReady, this,
+                   &Membrane::installSuperposition);
+  QObject::connect(m_strikePanel, &StrikePanel::strikeRequested, this,
+                   &Membrane::strike);
+  QObject::connect(m_strikePanel, &StrikePanel::wavExportRequested, this,
+                   &Membrane::exportWav);
+  QObject::connect(m_fdtdPanel, &FdtdPanel::toggled, this,
+                   &Membrane::setFdtdEnabled);
+  QObject::connect(m_fdtdPanel, &FdtdPanel::mediumChanged, this,
+                   &Membrane::updateFdtdMedium);
+  QObject::connect(m_fdtdPanel, &FdtdPanel::restartRequested, this,
+                   &Membrane::restartFdtd);
+  QObject::connect(spectrumPanel, &SpectrumPanel::modeSelected, this,
+                   &Membrane::activateMode);
+  QObject::connect(m_generator, &ModeGenerator::progressChanged, this,
+                   &Membrane::setGenerationProgress);
+  QObject::connect(m_generator, &ModeGenerator::exportFinished, this,
+                   &Membrane::finishExport);
+  QObject::connect(&m_nodalWatcher, SIGNAL(finished()), this,
+                   SLOT(installNodalOverlay()));
+  QObject::connect(m_besselOrderSbx, SIGNAL(valueChanged(int)), this,
                      SLOT(setSelectedBesselOrder(int))) ;
-  QObject::connect(besselRootSbx, SIGNAL(valueChanged(int)), this,
+  QObject::connect(m_besselRootSbx, SIGNAL(valueChanged(int)), this,
                      SLOT(setSelectedBesselRoot(int))) ;
+  QObject::connect(playbackSpeedSbx, SIGNAL(valueChanged(double)), this,
+                     SLOT(setPlaybackSpeed(double))) ;
   QObject::connect(modeNoneRB, &QRadioButton::toggled, this,
                    &Membrane::toggleModeNone);
   QObject::connect(modeItemRB, &QRadioButton::toggled, this,
@@ -255,6 +754,8 @@ void Membrane::setUpUi() {
                    &Membrane::toggleModeSliceColumn);
   QObject::connect(themeList, SIGNAL(currentIndexChanged(int)), this,
                    SLOT(changeTheme(int)));
+  QObject::connect(m_rendererList, SIGNAL(currentIndexChanged(int)), this,
+                   SLOT(setRenderer(int)));
 
   themeList->setCurrentIndex(7);
 }
@@ -35,9 +35,30 @@
 #include <QtDataVisualization/QSurfaceDataProxy>
 #include <QtWidgets/QSlider>
 #include <QtWidgets/QLabel>
+#include <QtWidgets/QComboBox>
+#include <QtWidgets/QProgressBar>
+#include <QtWidgets/QSpinBox>
+#include <QtWidgets/QStackedWidget>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QThreadPool>
+#include <QtCore/QTimer>
 #include <atomic>
+#ifdef DRUM_AUDIO_OUTPUT
+#include "drum_audio.h"
+#endif
+#include "cavity_view.h"
+#include "fdtd_panel.h"
+#include "fdtd_solver.h"
+#include "mesh_export.h"
+#include "mode_generator.h"
+#include "nodal_overlay.h"
+#include "query_server.h"
 #include "qt_helpers.h"
+#include "shader_view.h"
+#include "strike_panel.h"
 #include "solution.h"
+#include "superposition.h"
 
 using namespace QtDataVisualization;
 
@@ -45,8 +66,19 @@ class Membrane : public QObject {
   Q_OBJECT
 
  public:
+  const static double defaultPlaybackSpeed;
+  const static int pixelsPerSample;
+  const static int detailDelay;
+  const static int meshSlices;
+  const static int meshFrames;
+  const static int nodalInterval;
+  enum Renderer { SurfaceRenderer, ShaderRenderer };
+
   explicit Membrane(Solution* solution);
   ~Membrane();
+  // Answers point queries of the displayed mode or superposition on the
+  // local socket name; see QueryServer.
+  bool serveQueries(const QString& name);
 
     void initializeGraph();
     void initializeSeries();
@@ -58,22 +90,74 @@ class Membrane : public QObject {
                                                              | QAbstract3DGraph::SelectionSlice); }
  public Q_SLOTS:
     void changeTheme(int theme);
-    void updateTimeSlice();
+    void updateFrame();
+    void setPlaybackSpeed(double speed);
+    void setRenderer(int renderer);
     void setSelectedBesselOrder(int n);
     void setSelectedBesselRoot(int m);
+    void activateMode(int n, int m);
+    void installModeField(const ModeField& mode_field, int stride = 1);
+    void strike(const StrikeCondition& strike, int modeCount);
+    void installSuperposition(const Superposition& superposition);
+    void exportWav(const QString& fileName);
+    void exportMesh();
+    void finishExport(const QString& fileName, bool ok);
+    void setNodalLinesVisible(bool visible);
+    void installNodalOverlay();
+    void showCavityView();
+    void setFdtdEnabled(bool enabled);
+    void updateFdtdMedium();
+    void restartFdtd();
+    void setGenerationProgress(int percent);
+    void updateDetail();
 private:
   void activateNormalMode();
   void setUpUi();
   void setModeLabel();
+  void updateQuerySource();
+  void updateNodalLines();
+  int frameInterval() const;
+  QSize visibleDetail() const;
   Q3DSurface* m_graph;
   QSurfaceDataProxy *m_membraneProxy{0};
   QSurface3DSeries *m_membraneSeries{0};
-  std::atomic<int> m_timeSliceIndex{0};
   Solution* m_solution;
+  ModeGenerator* m_generator;
   QSurfaceDataArray* m_resetArray;
+  int m_modeStride;
+  QTimer* m_detailTimer;
   float m_selected_bessel_order;
   int   m_selected_bessel_root;
   QLabel* m_modeLabel;
+  QSpinBox* m_besselOrderSbx;
+  QSpinBox* m_besselRootSbx;
+  QProgressBar* m_generationProgress;
+  QStackedWidget* m_views;
+  ShaderView* m_shaderView;
+  QComboBox* m_rendererList;
+  int m_renderer;
+  QTimer* m_frameTimer;
+  QElapsedTimer m_frameClock;
+  double m_animationTime;
+  double m_playbackSpeed;
+  Superposition m_superposition;
+  double m_superpositionTime;
+  StrikePanel* m_strikePanel;
+  FdtdPanel* m_fdtdPanel;
+  FdtdSolver* m_fdtd;
+  bool m_fdtdFromMode;
+  QElapsedTimer m_fdtdStatusClock;
+  QueryServer* m_queryServer;
+  NodalOverlay m_nodalOverlay;
+  bool m_nodalLinesVisible;
+  QElapsedTimer m_nodalClock;
+  QThreadPool m_nodalPool;
+  QFutureWatcher<QImage> m_nodalWatcher;
+  bool m_nodalPending;
+  CavityView* m_cavityView;
+#ifdef DRUM_AUDIO_OUTPUT
+  DrumAudio* m_audio;
+#endif
   };
 
 #endif  // MEMBRANE_H
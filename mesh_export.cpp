@@ -0,0 +1,652 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  MeshExport Class.
+  Streams membrane animations as glTF or PLY meshes.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "mesh_export.h"
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QBuffer>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+#include <QtCore/QtEndian>
+#include <atomic>
+#include <cmath>
+#include "bessel.h"
+#include "mode_kernels.h"
+
+const int MeshExport::defaultRings = 96;
+const int MeshExport::defaultSectors = 192;
+// Peaks of a fifth of the radius read well without hiding the nodal lines.
+const float MeshExport::defaultHeightScale = 0.2f;
+const double MeshExport::defaultFrameRate = 30.0;
+
+namespace {
+
+// glTF component types and buffer view targets.
+const int glFloat = 5126;
+const int glUnsignedInt = 5125;
+const int glArrayBuffer = 34962;
+const int glElementArrayBuffer = 34963;
+
+void besselBatch(int n, const float* x, float* out, int count) {
+  if (!mode_kernels::cyl_bessel_j(n, x, out, count))
+    bessel::cyl_bessel_j(n, x, out, count);
+}
+
+template <typename T>
+bool writeValues(QIODevice* device, const T* values, int count) {
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+  QVector<T> swapped(count);
+  for (int i(0); i < count; i++)
+    qToLittleEndian(values[i], swapped.data() + i);
+  values = swapped.constData();
+#endif
+  const qint64 size = qint64(count) * sizeof(T);
+  return device->write(reinterpret_cast<const char*>(values), size) == size;
+}
+
+QJsonArray jsonVector(float x, float y, float z) {
+  return QJsonArray() << x << y << z;
+}
+
+// The time independent factors of the animation. Modes of the same order
+// and angle form a group, which shares its angular factors: a frame costs
+// one multiply-add per (ring, mode) and three per (vertex, group).
+class Tables {
+ public:
+  Tables(const QVector<Superposition::Mode>& modes, float radius, int rings,
+         int sectors);
+  // Positions and normals, 3 floats per vertex, at time t.
+  void evaluate(double t, float height, float* positions,
+                float* normals) const;
+
+ private:
+  struct Group {
+    int first;
+    int last;
+  };
+  QVector<Superposition::Mode> m_modes;
+  int m_rings;
+  int m_sectors;
+  QVector<float> m_radii;
+  QVector<float> m_cosines;
+  QVector<float> m_sines;
+  // J_n(k r) and k J_n'(k r), ring major.
+  QVector<float> m_radial;
+  QVector<float> m_slope;
+  QVector<Group> m_groups;
+  // cos(n (theta - theta0)) and -n sin(n (theta - theta0)), group major.
+  QVector<float> m_angular;
+  QVector<float> m_angularSlope;
+};
+
+Tables::Tables(const QVector<Superposition::Mode>& modes, float radius,
+               int rings, int sectors)
+    : m_modes(modes),
+      m_rings(rings),
+      m_sectors(sectors),
+      m_radii(rings),
+      m_cosines(sectors),
+      m_sines(sectors),
+      m_radial(rings * modes.size()),
+      m_slope(rings * modes.size())
+{
+  const int modeCount = modes.size();
+  for (int j(0); j < rings; j++) m_radii[j] = radius * (j + 1) / rings;
+  for (int s(0); s < sectors; s++) {
+    const double theta = 2 * M_PI * s / sectors;
+    m_cosines[s] = float(std::cos(theta));
+    m_sines[s] = float(std::sin(theta));
+  }
+  // J_0' = -J_1 and J_n' = J_{n-1} - n J_n / x; the radii are never 0.
+  QVector<float> arguments(rings);
+  QVector<float> values(rings);
+  QVector<float> lower(rings);
+  for (int i(0); i < modeCount; i++) {
+    const int n = int(modes[i].bessel_order_n);
+    const float k = modes[i].bessel_root / radius;
+    for (int j(0); j < rings; j++) arguments[j] = k * m_radii[j];
+    besselBatch(n, arguments.constData(), values.data(), rings);
+    besselBatch(n > 0 ? n - 1 : 1, arguments.constData(), lower.data(),
+                rings);
+    for (int j(0); j < rings; j++) {
+      m_radial[j * modeCount + i] = values[j];
+      m_slope[j * modeCount + i] =
+          k * (n > 0 ? lower[j] - n * values[j] / arguments[j] : -lower[j]);
+    }
+  }
+  for (int i(0); i < modeCount; i++) {
+    if (i == 0 || modes[i].bessel_order_n != modes[i - 1].bessel_order_n ||
+        modes[i].angle != modes[i - 1].angle) {
+      Group group = {i, i};
+      m_groups.append(group);
+      const double n = modes[i].bessel_order_n;
+      for (int s(0); s < sectors; s++) {
+        const double phase = n * (2 * M_PI * s / sectors - modes[i].angle);
+        m_angular.append(float(std::cos(phase)));
+        m_angularSlope.append(float(-n * std::sin(phase)));
+      }
+    }
+    m_groups.last().last = i + 1;
+  }
+}
+
+// The gradient in the plane is (z_r cos - z_theta sin / r,
+// z_r sin + z_theta cos / r); at the centre only the n = 1 modes have one,
+// T k / 2 (cos theta0, sin theta0).
+void Tables::evaluate(double t, float height, float* positions,
+                      float* normals) const {
+  const int modeCount = m_modes.size();
+  const int groupCount = m_groups.size();
+  QVector<float> temporal(modeCount);
+  float centre = 0.0f;
+  float centreX = 0.0f;
+  float centreY = 0.0f;
+  for (int i(0); i < modeCount; i++) {
+    const Superposition::Mode& mode = m_modes[i];
+    const double phase = std::fmod(mode.omega * t, 2 * M_PI);
+    temporal[i] =
+        float(mode.cosine * std::cos(phase) + mode.sine * std::sin(phase));
+    if (mode.bessel_order_n == 0.0f) centre += temporal[i];
+    if (mode.bessel_order_n == 1.0f) {
+      const float k = mode.bessel_root / m_radii.last();
+      centreX += temporal[i] * k / 2 * std::cos(mode.angle);
+      centreY += temporal[i] * k / 2 * std::sin(mode.angle);
+    }
+  }
+  const float centreNorm =
+      std::sqrt(1.0f + height * height * (centreX * centreX +
+                                          centreY * centreY));
+  positions[0] = 0.0f;
+  positions[1] = 0.0f;
+  positions[2] = height * centre;
+  normals[0] = -height * centreX / centreNorm;
+  normals[1] = -height * centreY / centreNorm;
+  normals[2] = 1.0f / centreNorm;
+
+  QVector<float> amplitude(groupCount);
+  QVector<float> amplitudeSlope(groupCount);
+  QVector<float> z(m_sectors);
+  QVector<float> zr(m_sectors);
+  QVector<float> zt(m_sectors);
+  for (int j(0); j < m_rings; j++) {
+    const float* radial = m_radial.constData() + j * modeCount;
+    const float* slope = m_slope.constData() + j * modeCount;
+    for (int g(0); g < groupCount; g++) {
+      float a = 0.0f;
+      float b = 0.0f;
+      for (int i = m_groups[g].first; i < m_groups[g].last; i++) {
+        a += temporal[i] * radial[i];
+        b += temporal[i] * slope[i];
+      }
+      amplitude[g] = a;
+      amplitudeSlope[g] = b;
+    }
+    std::fill(z.begin(), z.end(), 0.0f);
+    std::fill(zr.begin(), zr.end(), 0.0f);
+    std::fill(zt.begin(), zt.end(), 0.0f);
+    for (int g(0); g < groupCount; g++) {
+      const float a = amplitude[g];
+      const float b = amplitudeSlope[g];
+      const float* angular = m_angular.constData() + g * m_sectors;
+      const float* angularSlope = m_angularSlope.constData() + g * m_sectors;
+      for (int s(0); s < m_sectors; s++) {
+        z[s] += a * angular[s];
+        zr[s] += b * angular[s];
+        zt[s] += a * angularSlope[s];
+      }
+    }
+    const float r = m_radii[j];
+    for (int s(0); s < m_sectors; s++) {
+      const int v = 3 * (1 + j * m_sectors + s);
+      const float c = m_cosines[s];
+      const float sn = m_sines[s];
+      const float gx = height * (zr[s] * c - zt[s] * sn / r);
+      const float gy = height * (zr[s] * sn + zt[s] * c / r);
+      const float norm = std::sqrt(1.0f + gx * gx + gy * gy);
+      positions[v] = r * c;
+      positions[v + 1] = r * sn;
+      positions[v + 2] = height * z[s];
+      normals[v] = -gx / norm;
+      normals[v + 1] = -gy / norm;
+      normals[v + 2] = 1.0f / norm;
+    }
+  }
+}
+
+}  // namespace
+
+MeshExport::MeshExport(const QVector<Superposition::Mode>& modes,
+                       float radius)
+    : m_modes(modes),
+      m_radius(radius),
+      m_rings(defaultRings),
+      m_sectors(defaultSectors),
+      m_heightScale(defaultHeightScale),
+      m_start(0.0),
+      m_step(0.0),
+      m_frameCount(1),
+      m_frameRate(defaultFrameRate),
+      m_threadCount(0)
+{
+}
+
+void MeshExport::setGrid(int rings, int sectors) {
+  m_rings = qMax(1, rings);
+  m_sectors = qMax(3, sectors);
+}
+
+void MeshExport::setHeightScale(float scale) {
+  m_heightScale = scale;
+}
+
+void MeshExport::setFrames(double start, double step, int frameCount) {
+  m_start = start;
+  m_step = step;
+  m_frameCount = qMax(1, frameCount);
+}
+
+void MeshExport::setFrameRate(double frameRate) {
+  if (frameRate > 0.0) m_frameRate = frameRate;
+}
+
+// Frames computed concurrently; 0 or less means one per core.
+void MeshExport::setThreadCount(int count) {
+  m_threadCount = count;
+}
+
+int MeshExport::vertexCount() const {
+  return 1 + m_rings * m_sectors;
+}
+
+int MeshExport::triangleCount() const {
+  return m_sectors * (2 * m_rings - 1);
+}
+
+QVector<quint32> MeshExport::indices() const {
+  QVector<quint32> indices;
+  indices.reserve(3 * triangleCount());
+  for (int s(0); s < m_sectors; s++)
+    indices << 0 << quint32(1 + s) << quint32(1 + (s + 1) % m_sectors);
+  for (int j(0); j + 1 < m_rings; j++)
+    for (int s(0); s < m_sectors; s++) {
+      const quint32 a = 1 + j * m_sectors + s;
+      const quint32 b = 1 + j * m_sectors + (s + 1) % m_sectors;
+      const quint32 c = a + m_sectors;
+      const quint32 d = b + m_sectors;
+      indices << a << c << d << a << d << b;
+    }
+  return indices;
+}
+
+bool MeshExport::write(const QString& fileName,
+                       ProgressCallback progress) const {
+  if (m_modes.isEmpty()) return false;
+  if (fileName.endsWith(".ply", Qt::CaseInsensitive))
+    return writePly(fileName, progress);
+  return writeGltf(fileName, progress);
+}
+
+// Workers take frames in order and block while they are window frames
+// ahead of the writer, so the frame the writer waits for is never blocked
+// and at most window frames are held at once.
+bool MeshExport::stream(std::function<bool(int, const Frame&)> consume,
+                        ProgressCallback progress) const {
+  const Tables tables(m_modes, m_radius, m_rings, m_sectors);
+  const float height = m_heightScale * m_radius;
+  const int values = 3 * vertexCount();
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(m_threadCount > 0 ? m_threadCount
+                                           : QThread::idealThreadCount());
+  const int window = 2 * pool.maxThreadCount();
+  QMutex mutex;
+  QWaitCondition changed;
+  QMap<int, Frame> ready;
+  int written = 0;
+  bool stopped = false;
+  std::atomic<int> next{0};
+
+  auto worker = [&]() {
+    for (int i = next++; i < m_frameCount; i = next++) {
+      {
+        QMutexLocker locker(&mutex);
+        while (i >= written + window && !stopped) changed.wait(&mutex);
+        if (stopped) return;
+      }
+      Frame frame;
+      frame.positions.resize(values);
+      frame.normals.resize(values);
+      tables.evaluate(m_start + i * m_step, height, frame.positions.data(),
+                      frame.normals.data());
+      QMutexLocker locker(&mutex);
+      if (stopped) return;
+      ready.insert(i, frame);
+      changed.wakeAll();
+    }
+  };
+  QVector<QFuture<void> > futures;
+  for (int i(0); i < qMin(pool.maxThreadCount(), m_frameCount); i++)
+    futures << QtConcurrent::run(&pool, worker);
+
+  bool ok = true;
+  for (int i(0); ok && i < m_frameCount; i++) {
+    Frame frame;
+    {
+      QMutexLocker locker(&mutex);
+      while (!ready.contains(i)) changed.wait(&mutex);
+      frame = ready.take(i);
+    }
+    ok = consume(i, frame);
+    {
+      QMutexLocker locker(&mutex);
+      written = i + 1;
+      changed.wakeAll();
+    }
+    if (ok && progress) ok = progress(100 * (i + 1) / m_frameCount);
+  }
+  {
+    QMutexLocker locker(&mutex);
+    stopped = true;
+    changed.wakeAll();
+  }
+  for (int i(0); i < futures.size(); i++) futures[i].waitForFinished();
+  return ok;
+}
+
+// Binary buffer: base positions | base normals | indices | per frame
+// position offsets and normal offsets | key times | sparse weight indices |
+// sparse weight values. glTF is y up, so (x, y, z) is stored as (x, z, -y).
+bool MeshExport::writeGltf(const QString& fileName,
+                           ProgressCallback progress) const {
+  const QFileInfo info(fileName);
+  const QString binName = info.completeBaseName() + ".bin";
+  QSaveFile bin(info.dir().filePath(binName));
+  QSaveFile gltf(fileName);
+  if (!bin.open(QIODevice::WriteOnly) || !gltf.open(QIODevice::WriteOnly))
+    return false;
+
+  const int vertices = vertexCount();
+  const int values = 3 * vertices;
+  const qint64 vertexBytes = qint64(values) * sizeof(float);
+  const QVector<quint32> triangles = indices();
+  QVector<float> base(values);
+  QVector<float> up(values);
+  float extent = 0.0f;
+  for (int v(0); v < vertices; v++) {
+    const float r = v == 0 ? 0.0f : m_radius * ((v - 1) / m_sectors + 1) /
+                                        m_rings;
+    const double theta = v == 0 ? 0.0 : 2 * M_PI * ((v - 1) % m_sectors) /
+                                            m_sectors;
+    base[3 * v] = float(r * std::cos(theta));
+    base[3 * v + 1] = 0.0f;
+    base[3 * v + 2] = float(-r * std::sin(theta));
+    up[3 * v] = 0.0f;
+    up[3 * v + 1] = 1.0f;
+    up[3 * v + 2] = 0.0f;
+    extent = qMax(extent, qMax(std::fabs(base[3 * v]),
+                               std::fabs(base[3 * v + 2])));
+  }
+  bool ok = writeValues(&bin, base.constData(), values) &&
+            writeValues(&bin, up.constData(), values) &&
+            writeValues(&bin, triangles.constData(), triangles.size());
+
+  QVector<float> lowest(m_frameCount);
+  QVector<float> highest(m_frameCount);
+  QVector<float> offsets(values);
+  ok = ok && stream([&](int i, const Frame& frame) {
+    float low = 0.0f;
+    float high = 0.0f;
+    for (int v(0); v < vertices; v++) {
+      const float height = frame.positions[3 * v + 2];
+      offsets[3 * v] = 0.0f;
+      offsets[3 * v + 1] = height;
+      offsets[3 * v + 2] = 0.0f;
+      low = qMin(low, height);
+      high = qMax(high, height);
+    }
+    lowest[i] = low;
+    highest[i] = high;
+    if (!writeValues(&bin, offsets.constData(), values)) return false;
+    for (int v(0); v < vertices; v++) {
+      offsets[3 * v] = frame.normals[3 * v];
+      offsets[3 * v + 1] = frame.normals[3 * v + 2] - 1.0f;
+      offsets[3 * v + 2] = -frame.normals[3 * v + 1];
+    }
+    return writeValues(&bin, offsets.constData(), values);
+  }, progress);
+
+  QVector<float> times(m_frameCount);
+  QVector<quint32> keys(m_frameCount);
+  QVector<float> ones(m_frameCount, 1.0f);
+  for (int i(0); i < m_frameCount; i++) {
+    times[i] = float(i / m_frameRate);
+    keys[i] = quint32(i) * m_frameCount + i;
+  }
+  ok = ok && writeValues(&bin, times.constData(), m_frameCount) &&
+       writeValues(&bin, keys.constData(), m_frameCount) &&
+       writeValues(&bin, ones.constData(), m_frameCount);
+  if (!ok) {
+    bin.cancelWriting();
+    gltf.cancelWriting();
+    return false;
+  }
+
+  QJsonArray views;
+  QJsonArray accessors;
+  qint64 offset = 0;
+  auto addView = [&views, &offset](qint64 length, int target) {
+    QJsonObject view;
+    view["buffer"] = 0;
+    view["byteOffset"] = double(offset);
+    view["byteLength"] = double(length);
+    if (target) view["target"] = target;
+    views.append(view);
+    offset += length;
+    return views.size() - 1;
+  };
+  auto addAccessor = [&accessors](const QJsonObject& accessor) {
+    accessors.append(accessor);
+    return accessors.size() - 1;
+  };
+  auto vectors = [vertices](int view, qint64 byteOffset) {
+    QJsonObject accessor;
+    accessor["bufferView"] = view;
+    accessor["byteOffset"] = double(byteOffset);
+    accessor["componentType"] = glFloat;
+    accessor["count"] = vertices;
+    accessor["type"] = QStringLiteral("VEC3");
+    return accessor;
+  };
+
+  QJsonObject position = vectors(addView(vertexBytes, glArrayBuffer), 0);
+  position["min"] = jsonVector(-extent, 0.0f, -extent);
+  position["max"] = jsonVector(extent, 0.0f, extent);
+  QJsonObject attributes;
+  attributes["POSITION"] = addAccessor(position);
+  attributes["NORMAL"] =
+      addAccessor(vectors(addView(vertexBytes, glArrayBuffer), 0));
+  QJsonObject indexAccessor;
+  indexAccessor["bufferView"] =
+      addView(qint64(triangles.size()) * sizeof(quint32),
+              glElementArrayBuffer);
+  indexAccessor["componentType"] = glUnsignedInt;
+  indexAccessor["count"] = triangles.size();
+  indexAccessor["type"] = QStringLiteral("SCALAR");
+
+  QJsonArray targets;
+  QJsonArray weights;
+  const int frameView =
+      addView(2 * vertexBytes * m_frameCount, glArrayBuffer);
+  for (int i(0); i < m_frameCount; i++) {
+    QJsonObject offsetAccessor = vectors(frameView, 2 * vertexBytes * i);
+    offsetAccessor["min"] = jsonVector(0.0f, lowest[i], 0.0f);
+    offsetAccessor["max"] = jsonVector(0.0f, highest[i], 0.0f);
+    QJsonObject target;
+    target["POSITION"] = addAccessor(offsetAccessor);
+    target["NORMAL"] =
+        addAccessor(vectors(frameView, 2 * vertexBytes * i + vertexBytes));
+    targets.append(target);
+    weights.append(i == 0 ? 1.0 : 0.0);
+  }
+
+  const qint64 keyBytes = qint64(m_frameCount) * sizeof(float);
+  QJsonObject timeAccessor;
+  timeAccessor["bufferView"] = addView(keyBytes, 0);
+  timeAccessor["componentType"] = glFloat;
+  timeAccessor["count"] = m_frameCount;
+  timeAccessor["type"] = QStringLiteral("SCALAR");
+  timeAccessor["min"] = QJsonArray() << times.first();
+  timeAccessor["max"] = QJsonArray() << times.last();
+  QJsonObject sparseIndices;
+  sparseIndices["bufferView"] = addView(keyBytes, 0);
+  sparseIndices["componentType"] = glUnsignedInt;
+  QJsonObject sparseValues;
+  sparseValues["bufferView"] = addView(keyBytes, 0);
+  QJsonObject sparse;
+  sparse["count"] = m_frameCount;
+  sparse["indices"] = sparseIndices;
+  sparse["values"] = sparseValues;
+  QJsonObject weightAccessor;
+  weightAccessor["componentType"] = glFloat;
+  weightAccessor["count"] = double(qint64(m_frameCount) * m_frameCount);
+  weightAccessor["type"] = QStringLiteral("SCALAR");
+  weightAccessor["sparse"] = sparse;
+
+  QJsonObject primitive;
+  primitive["attributes"] = attributes;
+  primitive["indices"] = addAccessor(indexAccessor);
+  primitive["targets"] = targets;
+  QJsonObject mesh;
+  mesh["name"] = QStringLiteral("Drumhead");
+  mesh["primitives"] = QJsonArray() << primitive;
+  mesh["weights"] = weights;
+  QJsonObject node;
+  node["mesh"] = 0;
+  QJsonObject scene;
+  scene["nodes"] = QJsonArray() << 0;
+  QJsonObject sampler;
+  sampler["input"] = addAccessor(timeAccessor);
+  sampler["output"] = addAccessor(weightAccessor);
+  sampler["interpolation"] = QStringLiteral("LINEAR");
+  QJsonObject channelTarget;
+  channelTarget["node"] = 0;
+  channelTarget["path"] = QStringLiteral("weights");
+  QJsonObject channel;
+  channel["sampler"] = 0;
+  channel["target"] = channelTarget;
+  QJsonObject animation;
+  animation["samplers"] = QJsonArray() << sampler;
+  animation["channels"] = QJsonArray() << channel;
+  QJsonObject buffer;
+  buffer["uri"] = binName;
+  buffer["byteLength"] = double(offset);
+  QJsonObject asset;
+  asset["version"] = QStringLiteral("2.0");
+  asset["generator"] = QStringLiteral("circular_membrane");
+
+  QJsonObject root;
+  root["asset"] = asset;
+  root["scene"] = 0;
+  root["scenes"] = QJsonArray() << scene;
+  root["nodes"] = QJsonArray() << node;
+  root["meshes"] = QJsonArray() << mesh;
+  root["buffers"] = QJsonArray() << buffer;
+  root["bufferViews"] = views;
+  root["accessors"] = accessors;
+  if (m_frameCount > 1) root["animations"] = QJsonArray() << animation;
+  const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Compact);
+  if (gltf.write(json) != json.size() || !bin.commit()) {
+    gltf.cancelWriting();
+    return false;
+  }
+  return gltf.commit();
+}
+
+// The faces are the same in every frame and are encoded once.
+bool MeshExport::writePly(const QString& fileName,
+                          ProgressCallback progress) const {
+  const QFileInfo info(fileName);
+  const QString stem =
+      info.dir().filePath(info.completeBaseName()) + QStringLiteral("_%1.ply");
+  const int vertices = vertexCount();
+  const QVector<quint32> triangles = indices();
+  QByteArray faces;
+  {
+    QBuffer buffer(&faces);
+    buffer.open(QIODevice::WriteOnly);
+    for (int f(0); f < triangles.size() / 3; f++) {
+      buffer.putChar(3);
+      writeValues(&buffer, triangles.constData() + 3 * f, 3);
+    }
+  }
+  const QByteArray header =
+      QStringLiteral(
+          "ply\nformat binary_little_endian 1.0\n"
+          "comment circular_membrane animation frame\n"
+          "element vertex %1\n"
+          "property float x\nproperty float y\nproperty float z\n"
+          "property float nx\nproperty float ny\nproperty float nz\n"
+          "element face %2\nproperty list uchar uint vertex_indices\n"
+          "end_header\n")
+          .arg(vertices)
+          .arg(triangles.size() / 3)
+          .toLatin1();
+
+  QStringList written;
+  QVector<float> interleaved(6 * vertices);
+  bool ok = stream([&](int i, const Frame& frame) {
+    const QString name = stem.arg(i, 4, 10, QLatin1Char('0'));
+    QSaveFile file(name);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    for (int v(0); v < vertices; v++)
+      for (int c(0); c < 3; c++) {
+        interleaved[6 * v + c] = frame.positions[3 * v + c];
+        interleaved[6 * v + 3 + c] = frame.normals[3 * v + c];
+      }
+    if (file.write(header) != header.size() ||
+        !writeValues(&file, interleaved.constData(), interleaved.size()) ||
+        file.write(faces) != faces.size()) {
+      file.cancelWriting();
+      return false;
+    }
+    if (!file.commit()) return false;
+    written << name;
+    return true;
+  }, progress);
+  if (!ok)
+    for (const QString& name : written) QFile::remove(name);
+  return ok;
+}
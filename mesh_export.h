@@ -0,0 +1,105 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  MeshExport Class.
+  Streams membrane animations as glTF or PLY meshes.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef MESHEXPORT_H
+#define MESHEXPORT_H
+
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#include <functional>
+#include "solution.h"
+#include "superposition.h"
+
+// Streams an animation of a sum of modes (a single mode, or the modes of
+// a strike) to offline renderers as a triangle mesh. The polar grid of
+// rings x sectors nodes plus the centre becomes Cartesian vertices; the
+// centre is fanned to the first ring and each ring band split into two
+// triangles per sector, counter-clockwise seen from above. Heights are
+// displacement x heightScale x radius, and normals come from the analytic
+// gradient,
+//   dz/dr = sum T k J_n'(k r) cos(n (theta - theta0)),
+//   dz/dtheta = -sum T n J_n(k r) sin(n (theta - theta0)),
+// with the centre, where only n = 1 contributes, taken as the limit.
+//
+// Frames are the instants start + i step, i < frameCount: slices of one
+// period, or a continuous sequence; they are played back at frameRate.
+// Worker threads compute
+// whole frames while the calling thread writes them in order; a worker
+// may run at most a few frames ahead of the writer, so memory does not
+// grow with the frame count.
+//
+// Formats, chosen from the file name:
+//   .gltf  glTF 2.0 with a separate .bin next to it. The flat membrane is
+//          the base mesh (z up becomes glTF y up), each frame one morph
+//          target of position and normal offsets, and a weights animation
+//          blends linearly from one frame to the next. The one-hot weight
+//          keys are a sparse accessor, so the file stays linear in the
+//          frame count.
+//   .ply   one binary little endian PLY per frame, with vertex positions
+//          and normals: name.ply becomes name_0000.ply, name_0001.ply...
+class MeshExport {
+ public:
+  const static int defaultRings;
+  const static int defaultSectors;
+  const static float defaultHeightScale;
+  const static double defaultFrameRate;
+
+  MeshExport(const QVector<Superposition::Mode>& modes, float radius);
+  void setGrid(int rings, int sectors);
+  void setHeightScale(float scale);
+  void setFrames(double start, double step, int frameCount);
+  void setFrameRate(double frameRate);
+  void setThreadCount(int count);
+  int vertexCount() const;
+  int triangleCount() const;
+  // progress receives the percentage of frames written; returning false
+  // cancels the export and discards the files.
+  bool write(const QString& fileName,
+             ProgressCallback progress = ProgressCallback()) const;
+
+ private:
+  struct Frame {
+    QVector<float> positions;
+    QVector<float> normals;
+  };
+  bool stream(std::function<bool(int, const Frame&)> consume,
+              ProgressCallback progress) const;
+  bool writeGltf(const QString& fileName, ProgressCallback progress) const;
+  bool writePly(const QString& fileName, ProgressCallback progress) const;
+  QVector<quint32> indices() const;
+  QVector<Superposition::Mode> m_modes;
+  float m_radius;
+  int m_rings;
+  int m_sectors;
+  float m_heightScale;
+  double m_start;
+  double m_step;
+  int m_frameCount;
+  double m_frameRate;
+  int m_threadCount;
+};
+
+#endif
@@ -0,0 +1,151 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  Metrics Class.
+  Scoped timers and gauges for runtime instrumentation.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "metrics.h"
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QSaveFile>
+#include <QtCore/QTextStream>
+#include <limits>
+
+namespace {
+
+struct TimerSlot {
+  std::atomic<qint64> count{0};
+  std::atomic<qint64> totalNs{0};
+  std::atomic<qint64> minNs{std::numeric_limits<qint64>::max()};
+  std::atomic<qint64> maxNs{0};
+  std::atomic<qint64> lastNs{0};
+};
+
+TimerSlot timers[Metrics::TimerCount];
+std::atomic<qint64> gauges[Metrics::GaugeCount];
+
+const char* const timerNames[Metrics::TimerCount] = {
+    "generation",         "generation_root", "generation_radial",
+    "generation_angular", "frame_update",    "surface_update",
+    "frame_interval",     "fdtd_step",       "query"};
+
+const char* const gaugeNames[Metrics::GaugeCount] = {
+    "mode_field_bytes", "surface_array_bytes", "mode_cache_bytes"};
+}
+
+std::atomic<bool> Metrics::s_enabled{false};
+
+double Metrics::TimerStats::meanNs() const {
+  return count ? double(totalNs) / count : 0.0;
+}
+
+void Metrics::setEnabled(bool enabled) {
+  s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Metrics::reset() {
+  for (TimerSlot& slot : timers) {
+    slot.count = 0;
+    slot.totalNs = 0;
+    slot.minNs = std::numeric_limits<qint64>::max();
+    slot.maxNs = 0;
+    slot.lastNs = 0;
+  }
+  for (std::atomic<qint64>& value : gauges) value = 0;
+}
+
+void Metrics::record(Timer timer, qint64 ns) {
+  TimerSlot& slot = timers[timer];
+  slot.count.fetch_add(1, std::memory_order_relaxed);
+  slot.totalNs.fetch_add(ns, std::memory_order_relaxed);
+  slot.lastNs.store(ns, std::memory_order_relaxed);
+  qint64 min = slot.minNs.load(std::memory_order_relaxed);
+  while (ns < min && !slot.minNs.compare_exchange_weak(min, ns)) {
+  }
+  qint64 max = slot.maxNs.load(std::memory_order_relaxed);
+  while (ns > max && !slot.maxNs.compare_exchange_weak(max, ns)) {
+  }
+}
+
+void Metrics::setGauge(Gauge gauge, qint64 value) {
+  gauges[gauge].store(value, std::memory_order_relaxed);
+}
+
+Metrics::TimerStats Metrics::timerStats(Timer timer) {
+  const TimerSlot& slot = timers[timer];
+  TimerStats stats = {slot.count, slot.totalNs, slot.minNs, slot.maxNs,
+                      slot.lastNs};
+  if (!stats.count) stats.minNs = 0;
+  return stats;
+}
+
+qint64 Metrics::gauge(Gauge gauge) {
+  return gauges[gauge].load(std::memory_order_relaxed);
+}
+
+const char* Metrics::name(Timer timer) {
+  return timerNames[timer];
+}
+
+const char* Metrics::name(Gauge gauge) {
+  return gaugeNames[gauge];
+}
+
+bool Metrics::dump(const QString& fileName) {
+  QSaveFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+  if (fileName.endsWith(".csv", Qt::CaseInsensitive)) {
+    QTextStream out(&file);
+    out << "kind,name,count,total_ns,mean_ns,min_ns,max_ns,last_ns,value\n";
+    for (int i(0); i < TimerCount; i++) {
+      TimerStats stats = timerStats(Timer(i));
+      out << "timer," << name(Timer(i)) << ',' << stats.count << ','
+          << stats.totalNs << ',' << stats.meanNs() << ',' << stats.minNs
+          << ',' << stats.maxNs << ',' << stats.lastNs << ",\n";
+    }
+    for (int i(0); i < GaugeCount; i++)
+      out << "gauge," << name(Gauge(i)) << ",,,,,,," << gauge(Gauge(i))
+          << '\n';
+  } else {
+    QJsonObject timerObject;
+    for (int i(0); i < TimerCount; i++) {
+      TimerStats stats = timerStats(Timer(i));
+      QJsonObject entry;
+      entry["count"] = double(stats.count);
+      entry["total_ns"] = double(stats.totalNs);
+      entry["mean_ns"] = stats.meanNs();
+      entry["min_ns"] = double(stats.minNs);
+      entry["max_ns"] = double(stats.maxNs);
+      entry["last_ns"] = double(stats.lastNs);
+      timerObject[name(Timer(i))] = entry;
+    }
+    QJsonObject gaugeObject;
+    for (int i(0); i < GaugeCount; i++)
+      gaugeObject[name(Gauge(i))] = double(gauge(Gauge(i)));
+    QJsonObject root;
+    root["timers"] = timerObject;
+    root["gauges"] = gaugeObject;
+    file.write(QJsonDocument(root).toJson());
+  }
+  return file.commit();
+}
@@ -0,0 +1,105 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  Metrics Class.
+  Scoped timers and gauges for runtime instrumentation.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QString>
+#include <atomic>
+
+// Process wide runtime metrics: timers (count, total, min, max, last) and
+// gauges. Recording is lock free and may happen on any thread. Gauges are
+// always kept current. Timers are disabled by default, and while disabled
+// a MetricsTimer costs one relaxed atomic load and records nothing.
+class Metrics {
+ public:
+  enum Timer {
+    Generation,
+    GenerationRoot,
+    GenerationRadial,
+    GenerationAngular,
+    FrameUpdate,
+    // Heights written into the surface array, part of a frame update.
+    SurfaceUpdate,
+    FrameInterval,
+    FdtdStep,
+    Query,
+    TimerCount
+  };
+  enum Gauge {
+    ModeFieldBytes,
+    SurfaceArrayBytes,
+    ModeCacheBytes,
+    GaugeCount
+  };
+  struct TimerStats {
+    qint64 count;
+    qint64 totalNs;
+    qint64 minNs;
+    qint64 maxNs;
+    qint64 lastNs;
+    double meanNs() const;
+  };
+
+  static bool isEnabled() {
+    return s_enabled.load(std::memory_order_relaxed);
+  }
+  static void setEnabled(bool enabled);
+  static void reset();
+  static void record(Timer timer, qint64 ns);
+  static void setGauge(Gauge gauge, qint64 value);
+  static TimerStats timerStats(Timer timer);
+  static qint64 gauge(Gauge gauge);
+  static const char* name(Timer timer);
+  static const char* name(Gauge gauge);
+  // Writes all metrics as CSV if fileName ends in ".csv", JSON otherwise.
+  static bool dump(const QString& fileName);
+
+ private:
+  static std::atomic<bool> s_enabled;
+};
+
+// Records the lifetime of the scope under the given timer.
+class MetricsTimer {
+ public:
+  explicit MetricsTimer(Metrics::Timer timer)
+      : m_timer(timer), m_running(Metrics::isEnabled()) {
+    if (m_running) m_clock.start();
+  }
+  ~MetricsTimer() {
+    if (m_running) Metrics::record(m_timer, m_clock.nsecsElapsed());
+  }
+
+ private:
+  MetricsTimer(const MetricsTimer&);
+  MetricsTimer& operator=(const MetricsTimer&);
+  Metrics::Timer m_timer;
+  bool m_running;
+  QElapsedTimer m_clock;
+};
+
+#endif
@@ -0,0 +1,151 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  MetricsPanel Class.
+  Side panel with live performance metrics.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "metrics_panel.h"
+#include <QtWidgets/QFileDialog>
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QVBoxLayout>
+
+const int MetricsPanel::refreshInterval = 500;
+const int MetricsPanel::dumpInterval = 10000;
+
+namespace {
+QString milliseconds(double ns) {
+  return QString::number(ns / 1e6, 'f', 3);
+}
+
+QString megabytes(qint64 bytes) {
+  return QString::number(bytes / (1024.0 * 1024.0), 'f', 2);
+}
+}
+
+MetricsPanel::MetricsPanel(int frameInterval, QWidget* parent)
+    : QGroupBox(QStringLiteral("Performance"), parent),
+      m_frameInterval(frameInterval),
+      m_fpsFrames(0)
+{
+  setCheckable(true);
+  setChecked(false);
+
+  m_label = new QLabel(this);
+  m_label->setTextFormat(Qt::RichText);
+  m_label->setVisible(false);
+  QPushButton* dumpButton = new QPushButton("&Dump Metrics...", this);
+  m_periodicDump = new QCheckBox(
+      QString("Dump every %1 s").arg(dumpInterval / 1000), this);
+  m_periodicDump->setEnabled(false);
+
+  QVBoxLayout* vBox = new QVBoxLayout;
+  vBox->addWidget(m_label);
+  vBox->addWidget(dumpButton);
+  vBox->addWidget(m_periodicDump);
+  setLayout(vBox);
+
+  m_refreshTimer.setInterval(refreshInterval);
+  m_dumpTimer.setInterval(dumpInterval);
+  connect(this, &QGroupBox::toggled, this, &MetricsPanel::setMetricsEnabled);
+  connect(&m_refreshTimer, &QTimer::timeout, this, &MetricsPanel::refresh);
+  connect(&m_dumpTimer, &QTimer::timeout, this, &MetricsPanel::dump);
+  connect(dumpButton, &QPushButton::clicked, this, &MetricsPanel::dumpAs);
+  connect(m_periodicDump, &QCheckBox::toggled, this,
+          &MetricsPanel::setPeriodicDump);
+}
+
+void MetricsPanel::setMetricsEnabled(bool enabled) {
+  Metrics::setEnabled(enabled);
+  m_label->setVisible(enabled);
+  if (enabled) {
+    m_fpsFrames = Metrics::timerStats(Metrics::FrameInterval).count;
+    m_fpsClock.start();
+    m_refreshTimer.start();
+    refresh();
+  } else {
+    m_refreshTimer.stop();
+  }
+}
+
+// Frames per second are counted over the last refresh interval.
+void MetricsPanel::refresh() {
+  Metrics::TimerStats frames = Metrics::timerStats(Metrics::FrameInterval);
+  qint64 elapsed = m_fpsClock.restart();
+  double fps = elapsed ? 1000.0 * (frames.count - m_fpsFrames) / elapsed : 0.0;
+  m_fpsFrames = frames.count;
+
+  QString text = QString("<b>FPS:</b> %1 (target %2)<br>")
+                     .arg(fps, 0, 'f', 1)
+                     .arg(1000.0 / m_frameInterval, 0, 'f', 1);
+  Metrics::TimerStats update = Metrics::timerStats(Metrics::FrameUpdate);
+  text += QString("<b>Frame update:</b> %1 ms (max %2)<br>")
+              .arg(milliseconds(update.lastNs))
+              .arg(milliseconds(update.maxNs));
+  Metrics::TimerStats surface = Metrics::timerStats(Metrics::SurfaceUpdate);
+  text += QString("&nbsp;&nbsp;surface_update: %1 ms (max %2)<br>")
+              .arg(milliseconds(surface.lastNs))
+              .arg(milliseconds(surface.maxNs));
+  text += QString("<b>Generation:</b> %1 ms<br>")
+              .arg(milliseconds(
+                  Metrics::timerStats(Metrics::Generation).lastNs));
+  const Metrics::Timer phases[] = {
+      Metrics::GenerationRoot, Metrics::GenerationRadial,
+      Metrics::GenerationAngular};
+  for (Metrics::Timer phase : phases) {
+    Metrics::TimerStats stats = Metrics::timerStats(phase);
+    text += QString("&nbsp;&nbsp;%1: %2 ms total, %3 calls<br>")
+                .arg(Metrics::name(phase))
+                .arg(milliseconds(stats.totalNs))
+                .arg(stats.count);
+  }
+  text += QString("<b>Mode field:</b> %1 MB<br>")
+              .arg(megabytes(Metrics::gauge(Metrics::ModeFieldBytes)));
+  text += QString("<b>Surface array:</b> %1 MB<br>")
+              .arg(megabytes(Metrics::gauge(Metrics::SurfaceArrayBytes)));
+  text += QString("<b>Mode cache:</b> %1 MB")
+              .arg(megabytes(Metrics::gauge(Metrics::ModeCacheBytes)));
+  m_label->setText(text);
+}
+
+void MetricsPanel::dumpAs() {
+  QString fileName = QFileDialog::getSaveFileName(
+      this, QStringLiteral("Dump Metrics"), m_dumpFileName,
+      QStringLiteral("JSON (*.json);;CSV (*.csv)"));
+  if (fileName.isEmpty()) return;
+  m_dumpFileName = fileName;
+  m_periodicDump->setEnabled(true);
+  dump();
+}
+
+void MetricsPanel::dump() {
+  if (m_dumpFileName.isEmpty()) return;
+  if (!Metrics::dump(m_dumpFileName))
+    qWarning("Cannot write metrics to %s", qPrintable(m_dumpFileName));
+}
+
+void MetricsPanel::setPeriodicDump(bool enabled) {
+  if (enabled)
+    m_dumpTimer.start();
+  else
+    m_dumpTimer.stop();
+}
@@ -0,0 +1,66 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  MetricsPanel Class.
+  Side panel with live performance metrics.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef METRICSPANEL_H
+#define METRICSPANEL_H
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QTimer>
+#include <QtWidgets/QCheckBox>
+#include <QtWidgets/QGroupBox>
+#include <QtWidgets/QLabel>
+#include "metrics.h"
+
+// Checkable side panel showing the live Metrics. Checking it enables the
+// timers; metrics can be dumped to JSON or CSV once or periodically.
+class MetricsPanel : public QGroupBox {
+  Q_OBJECT
+
+ public:
+  const static int refreshInterval;
+  const static int dumpInterval;
+
+  explicit MetricsPanel(int frameInterval, QWidget* parent = 0);
+
+ public Q_SLOTS:
+  void setMetricsEnabled(bool enabled);
+  void refresh();
+  void dumpAs();
+  void dump();
+  void setPeriodicDump(bool enabled);
+
+ private:
+  int m_frameInterval;
+  QLabel* m_label;
+  QCheckBox* m_periodicDump;
+  QTimer m_refreshTimer;
+  QTimer m_dumpTimer;
+  QElapsedTimer m_fpsClock;
+  qint64 m_fpsFrames;
+  QString m_dumpFileName;
+};
+
+#endif
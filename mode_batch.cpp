@@ -0,0 +1,181 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  ModeBatch Class.
+  Parallel batch generation of mode fields into a chunked binary file.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "mode_batch.h"
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QPair>
+#include <QtCore/QSaveFile>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+#include <atomic>
+#include "mode_cache.h"
+
+const quint32 ModeBatch::formatVersion = 2;
+
+namespace {
+
+const char headerMagic[8] = {'D', 'R', 'U', 'M', 'B', 'T', 'C', 'H'};
+const char footerMagic[8] = {'D', 'R', 'U', 'M', 'I', 'N', 'D', 'X'};
+
+struct Job {
+  int grid;
+  float bessel_order_n;
+  int root_order_m;
+};
+
+template <typename T>
+bool writeValue(QIODevice* device, const T& value) {
+  return device->write(reinterpret_cast<const char*>(&value), sizeof(T)) ==
+         qint64(sizeof(T));
+}
+
+}  // namespace
+
+ModeBatch::ModeBatch()
+    : m_threadCount(0)
+{
+}
+
+void ModeBatch::setOrders(const QVector<float>& bessel_orders) {
+  m_orders = bessel_orders;
+}
+
+void ModeBatch::setRoots(const QVector<int>& root_orders) {
+  m_roots = root_orders;
+}
+
+void ModeBatch::setGrids(const QVector<Grid>& grids) {
+  m_grids = grids;
+}
+
+// Modes computed concurrently; 0 or less means one per core.
+void ModeBatch::setThreadCount(int count) {
+  m_threadCount = count;
+}
+
+int ModeBatch::modeCount() const {
+  return m_grids.size() * m_orders.size() * m_roots.size();
+}
+
+// Workers compute whole modes, one thread each, and queue them; the calling
+// thread writes them out. Workers block while the queue is full, which
+// bounds memory regardless of the number of modes.
+bool ModeBatch::write(const QString& fileName,
+                      ProgressCallback progress) const {
+  QVector<Job> jobs;
+  jobs.reserve(modeCount());
+  for (int g(0); g < m_grids.size(); g++)
+    for (float n : m_orders)
+      for (int m : m_roots) jobs.append(Job{g, n, m});
+  if (jobs.isEmpty()) return false;
+
+  QSaveFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly)) return false;
+  if (file.write(headerMagic, sizeof(headerMagic)) != sizeof(headerMagic) ||
+      !writeValue(&file, formatVersion) || !writeValue(&file, quint32(0))) {
+    file.cancelWriting();
+    return false;
+  }
+
+  QVector<Solution*> solutions;
+  for (const Grid& grid : m_grids) {
+    Solution* solution = new Solution(grid.sampleCount, grid.radius,
+                                      grid.wave_speed, QString(), false);
+    solution->setThreadCount(1);
+    solutions.append(solution);
+  }
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(m_threadCount > 0 ? m_threadCount
+                                           : QThread::idealThreadCount());
+  const int maxQueued = 2 * pool.maxThreadCount();
+  QMutex mutex;
+  QWaitCondition changed;
+  QList<QPair<int, ModeField> > queue;
+  bool stopped = false;
+  std::atomic<int> next{0};
+
+  auto worker = [&]() {
+    for (int i = next++; i < jobs.size(); i = next++) {
+      const Job& job = jobs[i];
+      ModeField mode_field = solutions[job.grid]->computeModeField(
+          job.bessel_order_n, job.root_order_m, ProgressCallback());
+      QMutexLocker locker(&mutex);
+      while (queue.size() >= maxQueued && !stopped) changed.wait(&mutex);
+      if (stopped) return;
+      queue.append(qMakePair(job.grid, mode_field));
+      changed.wakeAll();
+    }
+  };
+  QVector<QFuture<void> > futures;
+  for (int i(0); i < qMin(pool.maxThreadCount(), jobs.size()); i++)
+    futures << QtConcurrent::run(&pool, worker);
+
+  QVector<quint64> offsets;
+  offsets.reserve(jobs.size());
+  bool ok = true;
+  while (ok && offsets.size() < jobs.size()) {
+    QPair<int, ModeField> item;
+    {
+      QMutexLocker locker(&mutex);
+      while (queue.isEmpty()) changed.wait(&mutex);
+      item = queue.takeFirst();
+      changed.wakeAll();
+    }
+    const ModeField& mode_field = item.second;
+    offsets.append(quint64(file.pos()));
+    ok = ModeDiskCache::writeRecord(
+        &file,
+        solutions[item.first]->modeKey(mode_field.besselOrder(),
+                                       mode_field.rootOrder()),
+        mode_field);
+    if (ok && progress)
+      ok = progress(100 * offsets.size() / jobs.size());
+  }
+  {
+    QMutexLocker locker(&mutex);
+    stopped = true;
+    changed.wakeAll();
+  }
+  for (int i(0); i < futures.size(); i++) futures[i].waitForFinished();
+  qDeleteAll(solutions);
+
+  quint64 indexOffset = quint64(file.pos());
+  for (int i(0); ok && i < offsets.size(); i++)
+    ok = writeValue(&file, offsets[i]);
+  ok = ok && writeValue(&file, indexOffset) &&
+       writeValue(&file, quint64(offsets.size())) &&
+       file.write(footerMagic, sizeof(footerMagic)) == sizeof(footerMagic) &&
+       file.seek(sizeof(headerMagic) + sizeof(quint32)) &&
+       writeValue(&file, quint32(offsets.size()));
+  if (!ok) {
+    file.cancelWriting();
+    return false;
+  }
+  return file.commit();
+}
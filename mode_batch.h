@@ -0,0 +1,74 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  ModeBatch Class.
+  Parallel batch generation of mode fields into a chunked binary file.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef MODEBATCH_H
+#define MODEBATCH_H
+
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#include "solution.h"
+
+// Computes every (n, m) mode on every sampling grid in parallel and streams
+// the fields into one chunked binary file, holding at most a couple of
+// fields per thread in memory.
+//
+// File layout, native byte order:
+//   header   char[8] "DRUMBTCH", quint32 version, quint32 record count
+//            (0 while writing)
+//   records  one per mode in completion order, each byte for byte a
+//            ModeDiskCache file: fixed header with key, root, grid size and
+//            checksum, then radii | radial | thetas | angular floats
+//   index    quint64 file offset of every record
+//   footer   quint64 index offset, quint64 record count, char[8] "DRUMINDX"
+class ModeBatch {
+ public:
+  const static quint32 formatVersion;
+
+  struct Grid {
+    int sampleCount;
+    float radius;
+    float wave_speed;
+  };
+
+  ModeBatch();
+  void setOrders(const QVector<float>& bessel_orders);
+  void setRoots(const QVector<int>& root_orders);
+  void setGrids(const QVector<Grid>& grids);
+  void setThreadCount(int count);
+  int modeCount() const;
+  // progress receives the percentage of modes written; returning false
+  // cancels the batch and discards the file.
+  bool write(const QString& fileName,
+             ProgressCallback progress = ProgressCallback()) const;
+
+ private:
+  QVector<float> m_orders;
+  QVector<int> m_roots;
+  QVector<Grid> m_grids;
+  int m_threadCount;
+};
+
+#endif
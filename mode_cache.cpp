@@ -0,0 +1,279 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  Mode caches.
+  In-memory LRU and persistent, size capped caches of computed mode fields.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "mode_cache.h"
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QSaveFile>
+#include <cstring>
+
+const quint32 ModeDiskCache::formatVersion = 4;
+const qint64 ModeDiskCache::defaultBudget = qint64(256) << 20;
+
+namespace {
+
+const char magic[8] = {'D', 'R', 'U', 'M', 'M', 'O', 'D', 'E'};
+
+struct ModeFileHeader {
+  char magic[8];
+  quint32 version;
+  quint32 headerSize;
+  float bessel_order_n;
+  qint32 root_order_m;
+  qint32 sampleCount;
+  float radius;
+  float wave_speed;
+  float samplingTolerance;
+  float bessel_root;
+  qint32 rowCount;
+  qint32 columnCount;
+  quint64 checksum;
+};
+
+quint32 floatBits(float value) {
+  quint32 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+// 64 bit FNV-1a.
+quint64 checksum(const void* data, qint64 size) {
+  const uchar* bytes = static_cast<const uchar*>(data);
+  quint64 hash = 14695981039346656037ULL;
+  for (qint64 i(0); i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+}  // namespace
+
+bool ModeKey::operator==(const ModeKey& other) const {
+  return floatBits(bessel_order_n) == floatBits(other.bessel_order_n) &&
+         root_order_m == other.root_order_m &&
+         sampleCount == other.sampleCount &&
+         floatBits(radius) == floatBits(other.radius) &&
+         floatBits(wave_speed) == floatBits(other.wave_speed) &&
+         floatBits(samplingTolerance) == floatBits(other.samplingTolerance);
+}
+
+uint qHash(const ModeKey& key, uint seed) {
+  uint hash = seed;
+  hash = hash * 31 + floatBits(key.bessel_order_n);
+  hash = hash * 31 + uint(key.root_order_m);
+  hash = hash * 31 + uint(key.sampleCount);
+  hash = hash * 31 + floatBits(key.radius);
+  hash = hash * 31 + floatBits(key.wave_speed);
+  hash = hash * 31 + floatBits(key.samplingTolerance);
+  return hash;
+}
+
+ModeDiskCache::ModeDiskCache(const QString& directory, qint64 budget)
+    : m_directory(directory),
+      m_budget(budget)
+{
+  QDir().mkpath(m_directory);
+}
+
+QString ModeDiskCache::directory() const {
+  return m_directory;
+}
+
+QString ModeDiskCache::fileName(const ModeKey& key) const {
+  return QDir(m_directory).filePath(
+      QString("mode_%1_%2_%3_%4_%5_%6.bin")
+          .arg(key.bessel_order_n)
+          .arg(key.root_order_m)
+          .arg(key.sampleCount)
+          .arg(floatBits(key.radius), 8, 16, QChar('0'))
+          .arg(floatBits(key.wave_speed), 8, 16, QChar('0'))
+          .arg(floatBits(key.samplingTolerance), 8, 16, QChar('0')));
+}
+
+// The samples are read into memory owned by the field and the file is
+// closed before returning, so loaded fields hold no file descriptors.
+ModeField ModeDiskCache::load(const ModeKey& key) const {
+  QFile file(fileName(key));
+  if (!file.open(QIODevice::ReadOnly)) return ModeField();
+  ModeFileHeader header;
+  if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) !=
+      qint64(sizeof(header)))
+    return ModeField();
+
+  ModeKey stored = {header.bessel_order_n, header.root_order_m,
+                    header.sampleCount, header.radius, header.wave_speed,
+                    header.samplingTolerance};
+  if (std::memcmp(header.magic, magic, sizeof(magic)) ||
+      header.version != formatVersion ||
+      header.headerSize != sizeof(ModeFileHeader) || !(stored == key) ||
+      header.rowCount <= 0 || header.columnCount <= 0)
+    return ModeField();
+  int count = ModeField::dataSize(header.rowCount, header.columnCount);
+  qint64 payload = qint64(sizeof(float)) * count;
+  if (file.size() != qint64(sizeof(ModeFileHeader)) + payload)
+    return ModeField();
+  float* data = new float[count];
+  std::shared_ptr<const float> samples(data, std::default_delete<float[]>());
+  if (file.read(reinterpret_cast<char*>(data), payload) != payload ||
+      checksum(data, payload) != header.checksum)
+    return ModeField();
+
+  return ModeField(header.bessel_order_n, header.root_order_m,
+                   header.bessel_root, header.rowCount, header.columnCount,
+                   samples);
+}
+
+// Written through QSaveFile, so concurrent readers never see a partial file.
+bool ModeDiskCache::store(const ModeKey& key,
+                          const ModeField& mode_field) const {
+  QSaveFile file(fileName(key));
+  if (!file.open(QIODevice::WriteOnly)) return false;
+  if (!writeRecord(&file, key, mode_field)) {
+    file.cancelWriting();
+    return false;
+  }
+  if (!file.commit()) return false;
+  evict();
+  return true;
+}
+
+// Removes the least recently written files until the directory fits the
+// budget, always keeping the newest one.
+void ModeDiskCache::evict() const {
+  QFileInfoList files = QDir(m_directory).entryInfoList(
+      QStringList() << "mode_*.bin", QDir::Files, QDir::Time);
+  qint64 size = 0;
+  for (const QFileInfo& info : files) size += info.size();
+  while (size > m_budget && files.size() > 1) {
+    QFileInfo oldest = files.takeLast();
+    if (QFile::remove(oldest.absoluteFilePath())) size -= oldest.size();
+  }
+}
+
+// Writes the complete cache file contents, header and samples, of one mode
+// at the current position of device.
+bool ModeDiskCache::writeRecord(QIODevice* device, const ModeKey& key,
+                                const ModeField& mode_field) {
+  if (mode_field.isEmpty()) return false;
+  qint64 payload = mode_field.byteSize();
+  ModeFileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = formatVersion;
+  header.headerSize = sizeof(ModeFileHeader);
+  header.bessel_order_n = key.bessel_order_n;
+  header.root_order_m = key.root_order_m;
+  header.sampleCount = key.sampleCount;
+  header.radius = key.radius;
+  header.wave_speed = key.wave_speed;
+  header.samplingTolerance = key.samplingTolerance;
+  header.bessel_root = mode_field.besselRoot();
+  header.rowCount = mode_field.rowCount();
+  header.columnCount = mode_field.columnCount();
+  header.checksum = checksum(mode_field.data(), payload);
+
+  return device->write(reinterpret_cast<const char*>(&header),
+                       sizeof(header)) == qint64(sizeof(header)) &&
+         device->write(reinterpret_cast<const char*>(mode_field.data()),
+                       payload) == payload;
+}
+
+ModeCache::ModeCache(qint64 budget)
+    : m_budget(budget),
+      m_size(0)
+{
+}
+
+void ModeCache::setBudget(qint64 budget) {
+  QMutexLocker locker(&m_mutex);
+  m_budget = budget;
+  evict();
+}
+
+qint64 ModeCache::budget() const {
+  QMutexLocker locker(&m_mutex);
+  return m_budget;
+}
+
+qint64 ModeCache::size() const {
+  QMutexLocker locker(&m_mutex);
+  return m_size;
+}
+
+int ModeCache::count() const {
+  QMutexLocker locker(&m_mutex);
+  return m_entries.size();
+}
+
+bool ModeCache::contains(const ModeKey& key) const {
+  QMutexLocker locker(&m_mutex);
+  return m_entries.contains(key);
+}
+
+// A hit makes the entry the most recently used one.
+ModeField ModeCache::find(const ModeKey& key) {
+  QMutexLocker locker(&m_mutex);
+  auto entry = m_entries.find(key);
+  if (entry == m_entries.end()) return ModeField();
+  m_recent.splice(m_recent.end(), m_recent, entry->recent);
+  return entry->field;
+}
+
+void ModeCache::insert(const ModeKey& key, const ModeField& mode_field) {
+  if (mode_field.isEmpty()) return;
+  QMutexLocker locker(&m_mutex);
+  auto entry = m_entries.find(key);
+  if (entry != m_entries.end()) {
+    m_size -= entry->field.byteSize();
+    entry->field = mode_field;
+    m_recent.splice(m_recent.end(), m_recent, entry->recent);
+  } else {
+    Entry newEntry = {mode_field, m_recent.insert(m_recent.end(), key)};
+    m_entries.insert(key, newEntry);
+  }
+  m_size += mode_field.byteSize();
+  evict();
+}
+
+void ModeCache::clear() {
+  QMutexLocker locker(&m_mutex);
+  m_entries.clear();
+  m_recent.clear();
+  m_size = 0;
+}
+
+// The most recently used entry is kept even if it alone exceeds the budget.
+void ModeCache::evict() {
+  while (m_size > m_budget && m_recent.size() > 1) {
+    auto entry = m_entries.find(m_recent.front());
+    m_size -= entry->field.byteSize();
+    m_entries.erase(entry);
+    m_recent.pop_front();
+  }
+}
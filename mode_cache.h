@@ -0,0 +1,102 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  Mode caches.
+  In-memory LRU and persistent, size capped caches of computed mode fields.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef MODECACHE_H
+#define MODECACHE_H
+
+#include <QtCore/QHash>
+#include <QtCore/QIODevice>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <list>
+#include "mode_field.h"
+
+// Identifies a computed mode field.
+struct ModeKey {
+  float bessel_order_n;
+  int root_order_m;
+  int sampleCount;
+  float radius;
+  float wave_speed;
+  // 0 for the uniform grid of sampleCount points per axis.
+  float samplingTolerance;
+  bool operator==(const ModeKey& other) const;
+};
+
+uint qHash(const ModeKey& key, uint seed = 0);
+
+// On-disk cache of mode fields, one versioned binary file per key.
+// A hit reads the samples into memory owned by the field. A payload
+// checksum, the format version and the stored key guard against stale or
+// truncated files. The directory is kept within a budget in bytes by
+// removing the oldest files after each store.
+// Bump formatVersion whenever the numerics of mode generation change.
+class ModeDiskCache {
+ public:
+  const static quint32 formatVersion;
+  const static qint64 defaultBudget;
+
+  explicit ModeDiskCache(const QString& directory,
+                         qint64 budget = defaultBudget);
+  QString directory() const;
+  ModeField load(const ModeKey& key) const;
+  bool store(const ModeKey& key, const ModeField& mode_field) const;
+  static bool writeRecord(QIODevice* device, const ModeKey& key,
+                          const ModeField& mode_field);
+ private:
+  QString fileName(const ModeKey& key) const;
+  void evict() const;
+  QString m_directory;
+  qint64 m_budget;
+};
+
+// In-memory cache of mode fields with least recently used eviction.
+// The budget is in bytes of sample data; safe to use from several threads.
+class ModeCache {
+ public:
+  explicit ModeCache(qint64 budget);
+  void setBudget(qint64 budget);
+  qint64 budget() const;
+  qint64 size() const;
+  int count() const;
+  bool contains(const ModeKey& key) const;
+  ModeField find(const ModeKey& key);
+  void insert(const ModeKey& key, const ModeField& mode_field);
+  void clear();
+ private:
+  struct Entry {
+    ModeField field;
+    std::list<ModeKey>::iterator recent;
+  };
+  void evict();
+  QHash<ModeKey, Entry> m_entries;
+  std::list<ModeKey> m_recent;
+  qint64 m_budget;
+  qint64 m_size;
+  mutable QMutex m_mutex;
+};
+
+#endif
@@ -0,0 +1,164 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  ModeField Class.
+  Separable storage of a normal mode, time slices produced on demand.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "mode_field.h"
+#include <algorithm>
+#include "metrics.h"
+
+using namespace QtDataVisualization;
+
+ModeField::ModeField()
+    : m_bessel_order_n(0.0f),
+      m_root_order_m(0),
+      m_bessel_root(0.0f),
+      m_rowCount(0),
+      m_columnCount(0)
+{
+}
+
+ModeField::ModeField(float bessel_order_n, int root_order_m, float bessel_root,
+                     const QVector<float>& radii, const QVector<float>& radial,
+                     const QVector<float>& thetas, const QVector<float>& angular)
+    : m_bessel_order_n(bessel_order_n),
+      m_root_order_m(root_order_m),
+      m_bessel_root(bessel_root),
+      m_rowCount(radii.size()),
+      m_columnCount(thetas.size())
+{
+  float* data = new float[dataSize(m_rowCount, m_columnCount)];
+  m_data.reset(data, std::default_delete<float[]>());
+  data = std::copy(radii.constBegin(), radii.constEnd(), data);
+  data = std::copy(radial.constBegin(), radial.constEnd(), data);
+  data = std::copy(thetas.constBegin(), thetas.constEnd(), data);
+  std::copy(angular.constBegin(), angular.constEnd(), data);
+}
+
+ModeField::ModeField(float bessel_order_n, int root_order_m, float bessel_root,
+                     int rowCount, int columnCount,
+                     std::shared_ptr<const float> data)
+    : m_bessel_order_n(bessel_order_n),
+      m_root_order_m(root_order_m),
+      m_bessel_root(bessel_root),
+      m_rowCount(rowCount),
+      m_columnCount(columnCount),
+      m_data(data)
+{
+}
+
+int ModeField::dataSize(int rowCount, int columnCount) {
+  return 2 * (rowCount + columnCount);
+}
+
+bool ModeField::isEmpty() const {
+  return !m_rowCount || !m_columnCount;
+}
+
+float ModeField::besselOrder() const {
+  return m_bessel_order_n;
+}
+
+int ModeField::rootOrder() const {
+  return m_root_order_m;
+}
+
+float ModeField::besselRoot() const {
+  return m_bessel_root;
+}
+
+int ModeField::rowCount() const {
+  return m_rowCount;
+}
+
+int ModeField::columnCount() const {
+  return m_columnCount;
+}
+
+const float* ModeField::data() const {
+  return m_data.get();
+}
+
+const float* ModeField::radii() const {
+  return m_data.get();
+}
+
+const float* ModeField::radial() const {
+  return m_data.get() + m_rowCount;
+}
+
+const float* ModeField::thetas() const {
+  return m_data.get() + 2 * m_rowCount;
+}
+
+const float* ModeField::angular() const {
+  return m_data.get() + 2 * m_rowCount + m_columnCount;
+}
+
+float ModeField::displacement(int row, int column, float temporal) const {
+  return radial()[row] * angular()[column] * temporal;
+}
+
+bool ModeField::sameGrid(const ModeField& other) const {
+  if (m_rowCount != other.m_rowCount || m_columnCount != other.m_columnCount)
+    return false;
+  return std::equal(radii(), radii() + m_rowCount, other.radii()) &&
+         std::equal(thetas(), thetas() + m_columnCount, other.thetas());
+}
+
+QSurfaceDataArray* ModeField::newSurfaceDataArray(float temporal) const {
+  MetricsTimer timer(Metrics::SurfaceUpdate);
+  const float* thetas = this->thetas();
+  const float* angular = this->angular();
+  auto newArray = new QSurfaceDataArray();
+  newArray->reserve(m_rowCount);
+  for (int j(0); j < m_rowCount; j++) {
+    QSurfaceDataRow* newRow = new QSurfaceDataRow(m_columnCount);
+    float r = radii()[j];
+    float radial = this->radial()[j] * temporal;
+    for (int k(0); k < m_columnCount; k++)
+      (*newRow)[k].setPosition(QVector3D(thetas[k], radial * angular[k], r));
+    newArray->append(newRow);
+  }
+  return newArray;
+}
+
+// Rewrites only the heights of an array built by newSurfaceDataArray for a
+// field on the same grid. Rows are not shared, so nothing is detached or
+// allocated.
+void ModeField::updateSurfaceDataArray(float temporal,
+                                       QSurfaceDataArray& array) const {
+  MetricsTimer timer(Metrics::SurfaceUpdate);
+  const float* radial = this->radial();
+  const float* angular = this->angular();
+  for (int j(0); j < m_rowCount; j++) {
+    QSurfaceDataItem* items = array[j]->data();
+    const float a = radial[j] * temporal;
+    for (int k(0); k < m_columnCount; k++) items[k].setY(a * angular[k]);
+  }
+}
+
+qint64 ModeField::byteSize() const {
+  return qint64(sizeof(float)) * dataSize(m_rowCount, m_columnCount);
+}
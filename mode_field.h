@@ -0,0 +1,78 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  ModeField Class.
+  Separable storage of a normal mode, time slices produced on demand.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef MODEFIELD_H
+#define MODEFIELD_H
+
+#include <QtCore/QMetaType>
+#include <QtCore/QVector>
+#include <QtDataVisualization/QSurface3DSeries>
+#include <memory>
+
+using namespace QtDataVisualization;
+
+// A normal mode is separable, z(r, theta, t) = R(r) * Theta(theta) * T(t),
+// so only the sampled radial and angular factors are kept (O(N) memory).
+// Surface arrays for a given temporal factor T(t) are produced on demand.
+// The samples live in one immutable block, laid out as
+// radii | radial | thetas | angular, shared between copies.
+class ModeField {
+ public:
+  ModeField();
+  ModeField(float bessel_order_n, int root_order_m, float bessel_root,
+            const QVector<float>& radii, const QVector<float>& radial,
+            const QVector<float>& thetas, const QVector<float>& angular);
+  ModeField(float bessel_order_n, int root_order_m, float bessel_root,
+            int rowCount, int columnCount, std::shared_ptr<const float> data);
+  static int dataSize(int rowCount, int columnCount);
+  bool isEmpty() const;
+  float besselOrder() const;
+  int rootOrder() const;
+  float besselRoot() const;
+  int rowCount() const;
+  int columnCount() const;
+  const float* data() const;
+  const float* radii() const;
+  const float* radial() const;
+  const float* thetas() const;
+  const float* angular() const;
+  float displacement(int row, int column, float temporal) const;
+  bool sameGrid(const ModeField& other) const;
+  QSurfaceDataArray* newSurfaceDataArray(float temporal) const;
+  void updateSurfaceDataArray(float temporal, QSurfaceDataArray& array) const;
+  qint64 byteSize() const;
+ private:
+  float m_bessel_order_n;
+  int m_root_order_m;
+  float m_bessel_root;
+  int m_rowCount;
+  int m_columnCount;
+  std::shared_ptr<const float> m_data;
+};
+
+Q_DECLARE_METATYPE(ModeField)
+
+#endif
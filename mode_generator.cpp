@@ -0,0 +1,252 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  ModeGenerator Class.
+  Asynchronous, cancellable mode generation.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "mode_generator.h"
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QElapsedTimer>
+#include "bessel_zeros.h"
+#include "metrics.h"
+
+const qint64 ModeGenerator::defaultCacheBudget = 256 * 1024 * 1024;
+const int ModeGenerator::coarsestStride = 8;
+
+ModeGenerator::ModeGenerator(const Solution* solution, QObject* parent)
+    : QObject(parent),
+      m_solution(solution),
+      m_cache(defaultCacheBudget),
+      m_busy(false)
+{
+  qRegisterMetaType<ModeField>();
+  qRegisterMetaType<Superposition>();
+  qRegisterMetaType<QVector<ModeSpectrum::Entry> >();
+  m_prefetchPool.setMaxThreadCount(1);
+}
+
+ModeGenerator::~ModeGenerator() {
+  cancel();
+  ++m_prefetchRequest;
+  m_pool.waitForDone();
+  m_prefetchPool.waitForDone();
+}
+
+ModeCache& ModeGenerator::cache() {
+  return m_cache;
+}
+
+void ModeGenerator::request(float bessel_order_n, int root_order_m,
+                            const QSize& detail) {
+  int request = ++m_request;
+  m_busy = true;
+  ModeField cached =
+      m_cache.find(m_solution->modeKey(bessel_order_n, root_order_m));
+  if (!cached.isEmpty()) {
+    QMetaObject::invokeMethod(this, "finish", Qt::QueuedConnection,
+                              Q_ARG(int, request), Q_ARG(ModeField, cached),
+                              Q_ARG(int, 1), Q_ARG(bool, true));
+    return;
+  }
+  generate(request, bessel_order_n, root_order_m, coarsestStride,
+           ModeField(), detail);
+}
+
+void ModeGenerator::refine(const ModeField& mode_field, int stride,
+                           const QSize& detail) {
+  if (mode_field.isEmpty() || stride <= 1) return;
+  int request = ++m_request;
+  m_busy = true;
+  generate(request, mode_field.besselOrder(), mode_field.rootOrder(),
+           stride / 2, mode_field, detail);
+}
+
+// Levels from stride down to 1, each halving the stride and reusing the
+// previous one, coarser for the first. A new mode is looked up on disk
+// first. Progress spans all the levels that may run; a level that already
+// holds detail is the last.
+void ModeGenerator::generate(int request, float bessel_order_n,
+                             int root_order_m, int stride,
+                             const ModeField& coarser, const QSize& detail) {
+  QtConcurrent::run(&m_pool, [this, request, bessel_order_n, root_order_m,
+                              stride, coarser, detail]() {
+    const ModeKey key = m_solution->modeKey(bessel_order_n, root_order_m);
+    if (coarser.isEmpty()) {
+      ModeField cached =
+          m_solution->cachedModeField(bessel_order_n, root_order_m);
+      if (!cached.isEmpty()) {
+        m_cache.insert(key, cached);
+        Metrics::setGauge(Metrics::ModeCacheBytes, m_cache.size());
+        if (request != m_request) return;
+        QMetaObject::invokeMethod(this, "finish", Qt::QueuedConnection,
+                                  Q_ARG(int, request),
+                                  Q_ARG(ModeField, cached), Q_ARG(int, 1),
+                                  Q_ARG(bool, true));
+        return;
+      }
+    }
+    int levels = 0;
+    for (int s = stride; s >= 1; s /= 2) levels++;
+    int level = 0;
+    auto progress = [this, request, &level, levels](int percent) -> bool {
+      if (request != m_request) return false;
+      QMetaObject::invokeMethod(
+          this, "reportProgress", Qt::QueuedConnection, Q_ARG(int, request),
+          Q_ARG(int, (100 * level + percent) / levels));
+      return true;
+    };
+    ModeField mode_field = coarser;
+    for (int s = stride; s >= 1; s /= 2, level++) {
+      mode_field = m_solution->computeModeField(bessel_order_n, root_order_m,
+                                                progress, s, mode_field);
+      if (mode_field.isEmpty()) return;
+      bool last = s == 1 || (detail.isValid() &&
+                             mode_field.columnCount() >= detail.width() &&
+                             mode_field.rowCount() >= detail.height());
+      if (s == 1) {
+        m_solution->storeModeField(mode_field);
+        m_cache.insert(key, mode_field);
+        Metrics::setGauge(Metrics::ModeCacheBytes, m_cache.size());
+      }
+      if (request != m_request) return;
+      QMetaObject::invokeMethod(this, "finish", Qt::QueuedConnection,
+                                Q_ARG(int, request),
+                                Q_ARG(ModeField, mode_field), Q_ARG(int, s),
+                                Q_ARG(bool, last));
+      if (last) return;
+    }
+  });
+}
+
+void ModeGenerator::requestSuperposition(const StrikeCondition& strike,
+                                         int modeCount) {
+  int request = ++m_request;
+  m_busy = true;
+  QtConcurrent::run(&m_pool, [this, request, strike, modeCount]() {
+    auto progress = [this, request](int percent) -> bool {
+      if (request != m_request) return false;
+      QMetaObject::invokeMethod(this, "reportProgress", Qt::QueuedConnection,
+                                Q_ARG(int, request), Q_ARG(int, percent));
+      return true;
+    };
+    Superposition superposition =
+        m_solution->computeSuperposition(strike, modeCount, progress);
+    if (superposition.isEmpty() || request != m_request) return;
+    QMetaObject::invokeMethod(this, "finishSuperposition",
+                              Qt::QueuedConnection, Q_ARG(int, request),
+                              Q_ARG(Superposition, superposition));
+  });
+}
+
+void ModeGenerator::requestSpectrum(double cutoff_frequency) {
+  int request = ++m_spectrumRequest;
+  QtConcurrent::run(&m_pool, [this, request, cutoff_frequency]() {
+    if (request != m_spectrumRequest) return;
+    QElapsedTimer timer;
+    timer.start();
+    QVector<ModeSpectrum::Entry> spectrum =
+        m_solution->spectrum(cutoff_frequency);
+    QMetaObject::invokeMethod(
+        this, "finishSpectrum", Qt::QueuedConnection, Q_ARG(int, request),
+        Q_ARG(QVector<ModeSpectrum::Entry>, spectrum),
+        Q_ARG(qint64, timer.elapsed()));
+  });
+}
+
+void ModeGenerator::requestExport(const QString& fileName, ExportJob job) {
+  QtConcurrent::run(&m_pool, [this, fileName, job]() {
+    bool ok = job([this](int percent) -> bool {
+      QMetaObject::invokeMethod(this, "progressChanged", Qt::QueuedConnection,
+                                Q_ARG(int, percent));
+      return true;
+    });
+    QMetaObject::invokeMethod(this, "exportFinished", Qt::QueuedConnection,
+                              Q_ARG(QString, fileName), Q_ARG(bool, ok));
+  });
+}
+
+// Queues (n +- 1, m) and (n, m +- 1); a later call drops whatever is left
+// of the previous batch.
+void ModeGenerator::prefetchNeighbors(float bessel_order_n, int root_order_m) {
+  ++m_prefetchRequest;
+  if (bessel_order_n + 1 <= BesselZeros::maxOrder)
+    prefetch(bessel_order_n + 1, root_order_m);
+  if (root_order_m + 1 <= BesselZeros::maxRoot)
+    prefetch(bessel_order_n, root_order_m + 1);
+  if (bessel_order_n - 1 >= 0)
+    prefetch(bessel_order_n - 1, root_order_m);
+  if (root_order_m - 1 >= 1)
+    prefetch(bessel_order_n, root_order_m - 1);
+}
+
+void ModeGenerator::prefetch(float bessel_order_n, int root_order_m) {
+  ModeKey key = m_solution->modeKey(bessel_order_n, root_order_m);
+  if (m_cache.contains(key)) return;
+  int request = m_prefetchRequest;
+  QtConcurrent::run(&m_prefetchPool, [this, request, key]() {
+    if (request != m_prefetchRequest || m_cache.contains(key)) return;
+    auto progress = [this, request](int) -> bool {
+      return request == m_prefetchRequest;
+    };
+    // Computed serially on the prefetch thread itself, leaving the
+    // solution's pool to requests.
+    ModeField mode_field = m_solution->loadModeField(
+        key.bessel_order_n, key.root_order_m, progress, &m_prefetchPool);
+    m_cache.insert(key, mode_field);
+    Metrics::setGauge(Metrics::ModeCacheBytes, m_cache.size());
+  });
+}
+
+void ModeGenerator::cancel() {
+  ++m_request;
+  m_busy = false;
+}
+
+bool ModeGenerator::isBusy() const {
+  return m_busy;
+}
+
+void ModeGenerator::reportProgress(int request, int percent) {
+  if (request == m_request) emit progressChanged(percent);
+}
+
+void ModeGenerator::finish(int request, const ModeField& mode_field,
+                           int stride, bool last) {
+  if (request != m_request) return;
+  if (last) m_busy = false;
+  emit modeReady(mode_field, stride);
+}
+
+void ModeGenerator::finishSpectrum(
+    int request, const QVector<ModeSpectrum::Entry>& spectrum,
+    qint64 elapsed) {
+  if (request != m_spectrumRequest) return;
+  emit spectrumReady(spectrum, elapsed);
+}
+
+void ModeGenerator::finishSuperposition(int request,
+                                        const Superposition& superposition) {
+  if (request != m_request) return;
+  m_busy = false;
+  emit superpositionReady(superposition);
+}
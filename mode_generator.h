@@ -0,0 +1,113 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  ModeGenerator Class.
+  Asynchronous, cancellable mode generation.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef MODEGENERATOR_H
+#define MODEGENERATOR_H
+
+#include <QtCore/QObject>
+#include <QtCore/QSize>
+#include <QtCore/QThreadPool>
+#include <atomic>
+#include <functional>
+#include "mode_cache.h"
+#include "mode_field.h"
+#include "solution.h"
+#include "superposition.h"
+
+// Computes mode fields on a worker pool, off the GUI thread.
+// Every request supersedes the previous one: an in-flight computation is
+// cancelled at its next progress check and its result is never delivered.
+// Signals are emitted on the thread the generator lives in. Superpositions
+// share the request sequence with single modes and are not cached.
+// Generated fields are kept in an in-memory LRU cache; prefetched
+// neighbours of the current mode are computed serially on a separate single
+// thread pool, never on the solution's pool, so that they never delay a
+// request.
+// A mode that is not cached is delivered progressively: first every
+// coarsestStride-th row and column, then at half the stride, reusing the
+// coarser samples, until the field holds detail (width columns, height
+// rows) or is complete. Only complete fields are cached.
+class ModeGenerator : public QObject {
+  Q_OBJECT
+
+ public:
+  const static qint64 defaultCacheBudget;
+  const static int coarsestStride;
+
+  // Writes fileName, reporting the percentage done; false on failure.
+  typedef std::function<bool(ProgressCallback progress)> ExportJob;
+
+  explicit ModeGenerator(const Solution* solution, QObject* parent = 0);
+  ~ModeGenerator();
+  // An empty detail asks for the complete field.
+  void request(float bessel_order_n, int root_order_m,
+               const QSize& detail = QSize());
+  // Carries on refining mode_field, delivered at stride, towards detail.
+  void refine(const ModeField& mode_field, int stride, const QSize& detail);
+  void requestSuperposition(const StrikeCondition& strike, int modeCount);
+  // Spectrum requests have their own sequence and never cancel modes.
+  void requestSpectrum(double cutoff_frequency);
+  // Exports run on the pool outside the request sequence, so they are
+  // never cancelled; their progress goes to progressChanged as well.
+  void requestExport(const QString& fileName, ExportJob job);
+  void prefetchNeighbors(float bessel_order_n, int root_order_m);
+  void cancel();
+  bool isBusy() const;
+  ModeCache& cache();
+
+ Q_SIGNALS:
+  void progressChanged(int percent);
+  // stride is 1 for a complete field; isBusy() is false for the last one
+  // of a request.
+  void modeReady(const ModeField& mode_field, int stride);
+  void superpositionReady(const Superposition& superposition);
+  void spectrumReady(const QVector<ModeSpectrum::Entry>& spectrum,
+                     qint64 elapsed);
+  void exportFinished(const QString& fileName, bool ok);
+
+ private Q_SLOTS:
+  void reportProgress(int request, int percent);
+  void finish(int request, const ModeField& mode_field, int stride,
+              bool last);
+  void finishSuperposition(int request, const Superposition& superposition);
+  void finishSpectrum(int request, const QVector<ModeSpectrum::Entry>& spectrum,
+                      qint64 elapsed);
+
+ private:
+  void prefetch(float bessel_order_n, int root_order_m);
+  void generate(int request, float bessel_order_n, int root_order_m,
+                int stride, const ModeField& coarser, const QSize& detail);
+  const Solution* m_solution;
+  ModeCache m_cache;
+  QThreadPool m_pool;
+  QThreadPool m_prefetchPool;
+  std::atomic<int> m_request{0};
+  std::atomic<int> m_prefetchRequest{0};
+  std::atomic<int> m_spectrumRequest{0};
+  bool m_busy;
+};
+
+#endif
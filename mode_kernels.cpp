@@ -0,0 +1,150 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  Mode kernels.
+  Compile time specialized mode factors for low orders.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "mode_kernels.h"
+#include <cmath>
+#include <utility>
+
+namespace mode_kernels {
+namespace {
+
+const double kPi = 3.14159265358979323846;
+// Enough for double precision up to x = max(maxOrder, seriesLimit).
+const int kSeriesTerms = 32;
+// Enough for double precision at x = seriesLimit, where the Hankel
+// expansion of J_0 and J_1 is still short of its smallest term.
+const int kHankelTerms = 16;
+
+// J_n(x) = (x / 2)^n sum_k c_k x^2k, c_k = (-1)^k / (4^k k! (k + n)!),
+// with the (x / 2)^n / n! factored into c_0.
+template <int N>
+struct Series {
+  constexpr Series() : c() {
+    double term = 1.0;
+    for (int i = 1; i <= N; i++) term /= 2.0 * i;
+    for (int k = 0; k < kSeriesTerms; k++) {
+      c[k] = term;
+      term *= -1.0 / (4.0 * (k + 1) * (k + 1 + N));
+    }
+  }
+  double c[kSeriesTerms];
+};
+
+// J_v(x) = sqrt(2 / (pi x)) (P cos(x - phi) - Q sin(x - phi)) with
+// P = sum (-1)^k a_2k / x^2k and Q = sum (-1)^k a_2k+1 / x^2k+1,
+// a_k = prod_j (4 v^2 - (2 j - 1)^2) / (k! 8^k). The signs are folded
+// into p and q.
+template <int V>
+struct Hankel {
+  constexpr Hankel() : p(), q() {
+    double a = 1.0;
+    for (int k = 0; k < 2 * kHankelTerms; k++) {
+      double sign = (k / 2) % 2 ? -1.0 : 1.0;
+      if (k % 2)
+        q[k / 2] = sign * a;
+      else
+        p[k / 2] = sign * a;
+      double odd = 2.0 * k + 1.0;
+      a *= (4.0 * V * V - odd * odd) / (8.0 * (k + 1));
+    }
+  }
+  double p[kHankelTerms];
+  double q[kHankelTerms];
+};
+
+template <int V>
+double hankel(double x, double cosX, double sinX) {
+  static constexpr Hankel<V> h = Hankel<V>();
+  const double y = 1.0 / (x * x);
+  double p = 0.0;
+  double q = 0.0;
+  for (int k = kHankelTerms - 1; k >= 0; k--) {
+    p = p * y + h.p[k];
+    q = q * y + h.q[k];
+  }
+  q /= x;
+  // phi = (2 v + 1) pi / 4.
+  const double cosPhi = V ? -0.70710678118654752 : 0.70710678118654752;
+  const double sinPhi = 0.70710678118654752;
+  const double cosChi = cosX * cosPhi + sinX * sinPhi;
+  const double sinChi = sinX * cosPhi - cosX * sinPhi;
+  return std::sqrt(2.0 / (kPi * x)) * (p * cosChi - q * sinChi);
+}
+
+template <int N>
+double besselJ(double x) {
+  static constexpr Series<N> series = Series<N>();
+  x = std::fabs(x);
+  const double limit = N > seriesLimit ? double(N) : seriesLimit;
+  double value;
+  if (x < limit) {
+    const double y = x * x;
+    double sum = 0.0;
+    for (int k = kSeriesTerms - 1; k >= 0; k--) sum = sum * y + series.c[k];
+    value = sum;
+    for (int i = 0; i < N; i++) value *= x;
+  } else {
+    const double cosX = std::cos(x);
+    const double sinX = std::sin(x);
+    double previous = hankel<0>(x, cosX, sinX);
+    value = hankel<1>(x, cosX, sinX);
+    if (N == 0) return previous;
+    for (int k = 1; k < N; k++) {
+      double next = 2.0 * k / x * value - previous;
+      previous = value;
+      value = next;
+    }
+  }
+  return value;
+}
+
+// J_n(-x) = (-1)^n J_n(x).
+template <int N>
+void besselKernel(const float* x, float* out, int count) {
+  for (int i = 0; i < count; i++) {
+    double value = besselJ<N>(x[i]);
+    out[i] = float((N % 2 && x[i] < 0.0f) ? -value : value);
+  }
+}
+
+typedef void (*Kernel)(const float*, float*, int);
+
+template <int... N>
+const Kernel* besselKernels(std::integer_sequence<int, N...>) {
+  static const Kernel kernels[] = {&besselKernel<N>...};
+  return kernels;
+}
+
+}  // namespace
+
+bool cyl_bessel_j(int n, const float* x, float* out, int count) {
+  if (n < 0 || n > maxOrder) return false;
+  besselKernels(std::make_integer_sequence<int, maxOrder + 1>())[n](x, out,
+                                                                    count);
+  return true;
+}
+
+}  // namespace mode_kernels
@@ -0,0 +1,45 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  Mode kernels.
+  Compile time specialized mode factors for low orders.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef MODEKERNELS_H
+#define MODEKERNELS_H
+
+// Radial factors specialized at compile time for the low orders that are
+// asked for most. Each order 0 <= n <= maxOrder has its own instantiation
+// with the order dependent constants folded in:
+//   - below max(n, seriesLimit), the power series of J_n, whose
+//     coefficients are computed by the compiler;
+//   - above, the Hankel expansions of J_0 and J_1, again with constant
+//     coefficients, and the forward recurrence, which is stable for x > n.
+// Returns false for orders without a specialization, leaving out
+// untouched for the generic bessel::cyl_bessel_j.
+namespace mode_kernels {
+const int maxOrder = 16;
+const double seriesLimit = 12.0;
+bool cyl_bessel_j(int n, const float* x, float* out, int count);
+}
+
+#endif
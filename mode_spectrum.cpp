@@ -0,0 +1,64 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  ModeSpectrum Class.
+  Normal modes below a frequency cutoff.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "mode_spectrum.h"
+#include <algorithm>
+#include <cmath>
+#include "bessel.h"
+#include "bessel_zeros.h"
+#include "qt_helpers.h"
+
+using namespace qt_helpers;
+
+// About a million modes; listing them takes seconds, not minutes.
+const double ModeSpectrum::maximumRoot = 2000.0;
+
+QVector<ModeSpectrum::Entry> ModeSpectrum::below(double maxRoot,
+                                                 QThreadPool* pool) {
+  maxRoot = qMin(maxRoot, maximumRoot);
+  const int orderCount =
+      qBound(0, int(std::ceil(maxRoot)), BesselZeros::maxOrder + 1);
+  QVector<QVector<Entry> > orders(orderCount);
+  parallelFor(pool, orderCount, [&](int n) {
+    QVector<Entry>& entries = orders[n];
+    for (int m = 1; m <= BesselZeros::maxRoot; m++) {
+      double root = bessel::cyl_bessel_j_zero(n, m);
+      if (root >= maxRoot) break;
+      entries.append(Entry{n, m, root});
+    }
+  });
+
+  int count = 0;
+  for (const QVector<Entry>& entries : orders) count += entries.size();
+  QVector<Entry> spectrum;
+  spectrum.reserve(count);
+  for (const QVector<Entry>& entries : orders) spectrum += entries;
+  std::sort(spectrum.begin(), spectrum.end(),
+            [](const Entry& a, const Entry& b) {
+              return a.bessel_root < b.bessel_root;
+            });
+  return spectrum;
+}
@@ -0,0 +1,56 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  ModeSpectrum Class.
+  Normal modes below a frequency cutoff.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef MODESPECTRUM_H
+#define MODESPECTRUM_H
+
+#include <QtCore/QMetaType>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+
+// Every normal mode whose Bessel root j_{n,m} lies below a cutoff, sorted
+// by increasing root, i.e. by frequency.
+// Orders are independent, so they are scanned in parallel, one order per
+// task. An order stops at its first root above the cutoff, and since
+// j_{n,1} > n no order at or above the cutoff can contribute. There are
+// about maxRoot^2 / 4 modes below maxRoot, so the bound is clamped to
+// maximumRoot, and orders and roots to the range of BesselZeros.
+class ModeSpectrum {
+ public:
+  const static double maximumRoot;
+
+  struct Entry {
+    int bessel_order_n;
+    int root_order_m;
+    double bessel_root;
+  };
+
+  static QVector<Entry> below(double maxRoot, QThreadPool* pool);
+};
+
+Q_DECLARE_METATYPE(ModeSpectrum::Entry)
+
+#endif
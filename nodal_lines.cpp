@@ -0,0 +1,197 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  NodalLines Class.
+  Exact and traced nodal lines of the membrane.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "nodal_lines.h"
+#include <QtCore/QHash>
+#include <algorithm>
+#include <cmath>
+#include "bessel_zeros.h"
+#include "qt_helpers.h"
+
+const int NodalLines::circleSegments = 256;
+const int NodalLines::bandRows = 16;
+
+namespace {
+
+// A piece of zero level inside one cell, between two grid edges. Edges are
+// keyed by their lower node, twice over plus one for the radial edge, so
+// neighbouring cells find each other's ends.
+struct Segment {
+  qint64 keys[2];
+  NodalLines::Point points[2];
+};
+
+// Where the level crosses the edge from node a to node b.
+NodalLines::Point crossing(float level, float va, float vb,
+                           NodalLines::Point a, NodalLines::Point b) {
+  float t = vb != va ? qBound(0.0f, (level - va) / (vb - va), 1.0f) : 0.5f;
+  return NodalLines::Point{a.r + t * (b.r - a.r),
+                           a.theta + t * (b.theta - a.theta)};
+}
+
+// Follows segments from the end at key, appending their far points, until
+// the line leaves the grid or closes on itself.
+void extend(qint64 key, const QVector<Segment>& segments,
+            const QHash<qint64, QPair<int, int> >& ends, QVector<bool>& used,
+            NodalLines::Polyline& line) {
+  for (;;) {
+    QPair<int, int> pair = ends.value(key, qMakePair(-1, -1));
+    int next = -1;
+    for (int end : {pair.first, pair.second})
+      if (end >= 0 && !used[end / 2]) next = end;
+    if (next < 0) return;
+    const Segment& segment = segments[next / 2];
+    used[next / 2] = true;
+    const int far = 1 - next % 2;
+    line.append(segment.points[far]);
+    key = segment.keys[far];
+  }
+}
+
+}  // namespace
+
+QVector<NodalLines::Polyline> NodalLines::mode(float bessel_order_n,
+                                               int root_order_m,
+                                               float radius) {
+  QVector<Polyline> lines;
+  const int n = int(bessel_order_n);
+  BesselZeros& zeros = BesselZeros::instance();
+  const double outer = zeros.zero(n, root_order_m);
+  for (int i = 1; i < root_order_m; i++) {
+    const float r = float(radius * zeros.zero(n, i) / outer);
+    Polyline circle(circleSegments + 1);
+    for (int s(0); s <= circleSegments; s++)
+      circle[s] = Point{r, float(2 * M_PI * s / circleSegments)};
+    lines.append(circle);
+  }
+  // Each diameter passes the centre at both of its angles, so it stays a
+  // single line in views that unroll theta.
+  for (int k(0); k < n; k++) {
+    const float theta = float((2 * k + 1) * M_PI / (2 * n));
+    const float opposite = float(theta + M_PI);
+    lines.append(Polyline{Point{radius, theta}, Point{0.0f, theta},
+                          Point{0.0f, opposite}, Point{radius, opposite}});
+  }
+  return lines;
+}
+
+// Cells are classified by value > level, so an exact zero counts with the
+// negative side and a node on the line closes it rather than splitting it.
+// Saddle cells are resolved by the mean of their corners.
+QVector<NodalLines::Polyline> NodalLines::contour(
+    const float* values, const float* radii, int rowCount,
+    const float* thetas, int columnCount, QThreadPool* pool, float level) {
+  QVector<Polyline> lines;
+  if (rowCount < 3 || columnCount < 2) return lines;
+  const int columns = columnCount;
+  auto value = [&](int i, int k) {
+    return values[qMin(i, rowCount - 2) * columns + k];
+  };
+  auto point = [&](int i, int k) { return Point{radii[i], thetas[k]}; };
+  auto radialKey = [&](int i, int k) {
+    return (qint64(i) * columns + (k == columns - 1 ? 0 : k)) * 2 + 1;
+  };
+  auto angularKey = [&](int i, int k) {
+    return (qint64(i) * columns + k) * 2;
+  };
+
+  const int cellRows = rowCount - 1;
+  const int bands = (cellRows + bandRows - 1) / bandRows;
+  QVector<QVector<Segment> > found(bands);
+  qt_helpers::parallelFor(pool, bands, [&](int band) {
+    QVector<Segment>& out = found[band];
+    const int last = qMin(cellRows, (band + 1) * bandRows);
+    for (int i = band * bandRows; i < last; i++) {
+      for (int k(0); k < columns - 1; k++) {
+        // Corners counter clockwise in (theta, r) from the lower left, and
+        // edge e joins corner e to corner e + 1.
+        const int rows[4] = {i, i, i + 1, i + 1};
+        const int cols[4] = {k, k + 1, k + 1, k};
+        float v[4];
+        int inside = 0;
+        for (int c(0); c < 4; c++) {
+          v[c] = value(rows[c], cols[c]);
+          if (v[c] > level) inside |= 1 << c;
+        }
+        if (inside == 0 || inside == 15) continue;
+        qint64 keys[4] = {angularKey(i, k), radialKey(i, k + 1),
+                          angularKey(i + 1, k), radialKey(i, k)};
+        Point points[4];
+        int crossed[4];
+        int count = 0;
+        for (int e(0); e < 4; e++) {
+          const int a = e, b = (e + 1) % 4;
+          if (((inside >> a) & 1) == ((inside >> b) & 1)) continue;
+          points[e] = crossing(level, v[a], v[b], point(rows[a], cols[a]),
+                               point(rows[b], cols[b]));
+          crossed[count++] = e;
+        }
+        if (count == 2) {
+          const int a = crossed[0], b = crossed[1];
+          out.append(Segment{{keys[a], keys[b]}, {points[a], points[b]}});
+        } else {
+          // Cut off the two corners whose side differs from the centre.
+          const bool centre = (v[0] + v[1] + v[2] + v[3]) / 4 > level;
+          const int first = centre == bool(inside & 1) ? 0 : 3;
+          for (int j(0); j < 2; j++) {
+            const int a = (first + 2 * j) % 4, b = (a + 1) % 4;
+            out.append(Segment{{keys[a], keys[b]}, {points[a], points[b]}});
+          }
+        }
+      }
+    }
+  });
+
+  QVector<Segment> segments;
+  for (const QVector<Segment>& band : found) segments += band;
+  QHash<qint64, QPair<int, int> > ends;
+  ends.reserve(segments.size() * 2);
+  for (int s(0); s < segments.size(); s++) {
+    for (int end(0); end < 2; end++) {
+      auto found = ends.find(segments[s].keys[end]);
+      if (found == ends.end())
+        ends.insert(segments[s].keys[end], qMakePair(s * 2 + end, -1));
+      else
+        found.value().second = s * 2 + end;
+    }
+  }
+  QVector<bool> used(segments.size(), false);
+  for (int s(0); s < segments.size(); s++) {
+    if (used[s]) continue;
+    used[s] = true;
+    Polyline line{segments[s].points[0], segments[s].points[1]};
+    extend(segments[s].keys[1], segments, ends, used, line);
+    Polyline back{segments[s].points[0]};
+    extend(segments[s].keys[0], segments, ends, used, back);
+    if (back.size() > 1) {
+      std::reverse(back.begin(), back.end());
+      back.removeLast();
+      line = back + line;
+    }
+    lines.append(line);
+  }
+  return lines;
+}
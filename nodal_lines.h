@@ -0,0 +1,64 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  NodalLines Class.
+  Exact and traced nodal lines of the membrane.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef NODALLINES_H
+#define NODALLINES_H
+
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+
+// Nodal lines of the membrane as polylines of polar points (r, theta).
+// A single mode has an exact nodal set, read off the root table: m - 1
+// circles at r = R j_{n,i} / j_{n,m} and n diameters where
+// cos(n theta) = 0. Superposed or simulated fields have no such closed
+// form, so their zero level is traced by marching squares over the polar
+// grid they are sampled on, bands of rows in parallel, and the segments
+// are stitched into polylines afterwards. Points stay polar so that each
+// view can map them to its own texture or mesh space.
+class NodalLines {
+ public:
+  struct Point {
+    float r;
+    float theta;
+  };
+  typedef QVector<Point> Polyline;
+
+  const static int circleSegments;
+  const static int bandRows;
+
+  static QVector<Polyline> mode(float bessel_order_n, int root_order_m,
+                                float radius);
+  // values holds rowCount x columnCount samples, row major, on radii from
+  // the centre to the rim and thetas over [0, 2 pi], the last column
+  // repeating the first. The rim row is a node of every field, so it is
+  // classified with the row inside it rather than traced.
+  static QVector<Polyline> contour(const float* values, const float* radii,
+                                   int rowCount, const float* thetas,
+                                   int columnCount, QThreadPool* pool,
+                                   float level = 0.0f);
+};
+
+#endif
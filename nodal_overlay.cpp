@@ -0,0 +1,89 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  NodalOverlay Class.
+  Nodal lines painted over the surface texture.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "nodal_overlay.h"
+#include <QtGui/QPainter>
+#include <QtGui/QPainterPath>
+#include <algorithm>
+#include <cmath>
+
+const int NodalOverlay::textureSize = 1024;
+const qreal NodalOverlay::lineWidth = 4.0;
+const QColor NodalOverlay::lineColor(200, 30, 30);
+
+namespace {
+
+// Fractional index of x in the ascending samples.
+qreal indexOf(float x, const float* samples, int count) {
+  const float* upper = std::upper_bound(samples, samples + count, x);
+  int i = qBound(1, int(upper - samples), count - 1);
+  float span = samples[i] - samples[i - 1];
+  return i - 1 + (span > 0.0f ? qBound(0.0f, (x - samples[i - 1]) / span,
+                                       1.0f)
+                              : 0.0f);
+}
+
+}  // namespace
+
+// A smaller copy of the texture keeps repainting and uploading cheap
+// enough to follow a moving field.
+NodalOverlay::NodalOverlay(const QImage& texture)
+    : m_base(texture.scaled(textureSize, textureSize, Qt::IgnoreAspectRatio,
+                            Qt::SmoothTransformation)
+                 .convertToFormat(QImage::Format_RGB32))
+{
+}
+
+QImage NodalOverlay::paint(const QVector<NodalLines::Polyline>& lines,
+                           const float* radii, int rowCount,
+                           const float* thetas, int columnCount) const {
+  QImage image(m_base);
+  if (rowCount < 2 || columnCount < 2) return image;
+  const qreal width = image.width(), height = image.height();
+  QPainterPath path;
+  for (const NodalLines::Polyline& line : lines) {
+    for (int i(0); i < line.size(); i++) {
+      const NodalLines::Point& p = line[i];
+      QPointF point(width * indexOf(p.theta, thetas, columnCount) /
+                        (columnCount - 1),
+                    height * (1.0 - indexOf(p.r, radii, rowCount) /
+                                        (rowCount - 1)));
+      const bool joined =
+          i > 0 && std::fabs(p.theta - line[i - 1].theta) < M_PI &&
+          (p.r > 0.0f || line[i - 1].r > 0.0f);
+      if (joined)
+        path.lineTo(point);
+      else
+        path.moveTo(point);
+    }
+  }
+  QPainter painter(&image);
+  painter.setRenderHint(QPainter::Antialiasing);
+  painter.setPen(QPen(lineColor, lineWidth, Qt::SolidLine, Qt::RoundCap,
+                      Qt::RoundJoin));
+  painter.drawPath(path);
+  return image;
+}
@@ -0,0 +1,55 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  NodalOverlay Class.
+  Nodal lines painted over the surface texture.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef NODALOVERLAY_H
+#define NODALOVERLAY_H
+
+#include <QtGui/QColor>
+#include <QtGui/QImage>
+#include "nodal_lines.h"
+
+// Draws nodal lines into the texture of the Q3DSurface series. The surface
+// maps its texture by grid index, columns across and rows up from the
+// centre, so points go to their fractional row and column on the displayed
+// grid; lines stay sharp however coarse the mesh is. Steps through the
+// centre or across the theta seam have no length on the membrane and are
+// not drawn.
+class NodalOverlay {
+ public:
+  const static int textureSize;
+  const static qreal lineWidth;
+  const static QColor lineColor;
+
+  explicit NodalOverlay(const QImage& texture);
+  QImage paint(const QVector<NodalLines::Polyline>& lines,
+               const float* radii, int rowCount, const float* thetas,
+               int columnCount) const;
+
+ private:
+  QImage m_base;
+};
+
+#endif
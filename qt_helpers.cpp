@@ -24,7 +24,9 @@
  **/
 
 #include "qt_helpers.h"
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtDataVisualization/QSurface3DSeries>
+#include <atomic>
 
 namespace qt_helpers {
 
@@ -51,4 +53,29 @@ void clearSurfaceDataArray(QSurfaceDataArray& array) {
   for (int j(0); j < array.size(); j++) delete array[j];
   array.clear();
 }
+
+// The memory held by the rows and items of array.
+qint64 surfaceDataArrayBytes(const QSurfaceDataArray& array) {
+  qint64 bytes = 0;
+  for (int j(0); j < array.size(); j++)
+    bytes += sizeof(QSurfaceDataRow) +
+             array[j]->size() * sizeof(QSurfaceDataItem);
+  return bytes;
+}
+
+// Runs body(0) .. body(count - 1) on up to maxThreadCount() threads of pool.
+// Workers, the calling thread included, pull indices from a shared counter,
+// so faster threads take over the remaining work of slower ones.
+void parallelFor(QThreadPool* pool, int count, std::function<void(int)> body) {
+  std::atomic<int> next{0};
+  auto worker = [&next, &body, count]() {
+    for (int i = next++; i < count; i = next++) body(i);
+  };
+  int helpers = qMin(pool->maxThreadCount(), count) - 1;
+  QVector<QFuture<void> > futures;
+  futures.reserve(qMax(0, helpers));
+  for (int i(0); i < helpers; i++) futures << QtConcurrent::run(pool, worker);
+  worker();
+  for (int i(0); i < futures.size(); i++) futures[i].waitForFinished();
+}
 }
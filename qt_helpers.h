@@ -26,7 +26,9 @@
 #ifndef QTHELPERS_H
 #define QTHELPERS_H
 
+#include <QtCore/QThreadPool>
 #include <QtDataVisualization/QSurface3DSeries>
+#include <functional>
 
 using namespace QtDataVisualization;
 
@@ -34,6 +36,8 @@ namespace qt_helpers {
 QSurfaceDataArray*  newSurfaceDataArrayFromSource( QSurfaceDataArray& source_surface_data_array,
                                                   std::function<void(QSurfaceDataItem&)> modifier );
 void clearSurfaceDataArray( QSurfaceDataArray& array);
+qint64 surfaceDataArrayBytes(const QSurfaceDataArray& array);
+void parallelFor(QThreadPool* pool, int count, std::function<void(int)> body);
 }
 
 #endif
@@ -0,0 +1,184 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  QueryServer Class.
+  Point queries from other processes over a local socket.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "query_server.h"
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QtEndian>
+#include <QtNetwork/QLocalServer>
+#include <QtNetwork/QLocalSocket>
+#include <cstring>
+
+const char* const QueryServer::defaultName = "circular_membrane";
+// 48 MB of points per request; longer streams are split by the client.
+const quint32 QueryServer::maximumCount = 1 << 22;
+
+namespace {
+
+const char requestMagic[4] = {'C', 'M', 'Q', '1'};
+const char replyMagic[4] = {'C', 'M', 'R', '1'};
+const int requestHeaderSize = 8;
+const int replyHeaderSize = 12;
+const int pointSize = 3 * sizeof(float);
+
+float readFloat(const char* data) {
+  quint32 bits = qFromLittleEndian<quint32>(
+      reinterpret_cast<const uchar*>(data));
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+void writeFloat(char* data, float value) {
+  quint32 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  qToLittleEndian(bits, reinterpret_cast<uchar*>(data));
+}
+
+}  // namespace
+
+QueryServer::QueryServer(const Solution* solution, QObject* parent)
+    : QObject(parent),
+      m_solution(solution),
+      m_server(new QLocalServer(this)),
+      m_nextConnection(0)
+{
+  connect(m_server, &QLocalServer::newConnection, this,
+          &QueryServer::acceptConnections);
+}
+
+// Replies still queued by the pool are dropped with the object.
+QueryServer::~QueryServer() {
+  m_pool.waitForDone();
+}
+
+// A name left behind by a crashed instance is reclaimed.
+bool QueryServer::listen(const QString& name) {
+  if (m_server->listen(name)) return true;
+  if (m_server->serverError() != QAbstractSocket::AddressInUseError)
+    return false;
+  QLocalServer::removeServer(name);
+  return m_server->listen(name);
+}
+
+QString QueryServer::errorString() const {
+  return m_server->errorString();
+}
+
+// Requests already being evaluated keep the modes they started with.
+void QueryServer::setModes(const QVector<Superposition::Mode>& modes) {
+  m_modes = modes;
+}
+
+void QueryServer::acceptConnections() {
+  while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+    const int id = m_nextConnection++;
+    Connection connection = {socket, QByteArray(), false};
+    m_connections.insert(id, connection);
+    connect(socket, &QLocalSocket::readyRead, this,
+            [this, id]() { receive(id); });
+    connect(socket, &QLocalSocket::disconnected, this,
+            [this, id]() { drop(id); });
+  }
+}
+
+void QueryServer::receive(int connection) {
+  if (!m_connections.contains(connection)) return;
+  Connection& state = m_connections[connection];
+  state.buffer.append(state.socket->readAll());
+  processNext(connection);
+}
+
+void QueryServer::drop(int connection) {
+  if (!m_connections.contains(connection)) return;
+  m_connections[connection].socket->deleteLater();
+  m_connections.remove(connection);
+}
+
+QByteArray QueryServer::header(Status status, quint32 count) {
+  QByteArray response(replyHeaderSize, Qt::Uninitialized);
+  std::memcpy(response.data(), replyMagic, 4);
+  uchar* fields = reinterpret_cast<uchar*>(response.data());
+  qToLittleEndian(quint32(status), fields + 4);
+  qToLittleEndian(count, fields + 8);
+  return response;
+}
+
+// One request of a connection is evaluated at a time; the next complete
+// one in its buffer starts when the reply has been written.
+void QueryServer::processNext(int connection) {
+  Connection& state = m_connections[connection];
+  while (!state.busy && state.buffer.size() >= requestHeaderSize) {
+    const char* data = state.buffer.constData();
+    const quint32 count =
+        qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(data + 4));
+    if (std::memcmp(data, requestMagic, 4) != 0 || count > maximumCount) {
+      qWarning("Malformed point query, closing the connection");
+      state.buffer.clear();
+      state.socket->write(header(BadRequest, 0));
+      state.socket->disconnectFromServer();
+      return;
+    }
+    const int size = requestHeaderSize + int(count) * pointSize;
+    if (state.buffer.size() < size) return;
+    const QByteArray payload =
+        state.buffer.mid(requestHeaderSize, size - requestHeaderSize);
+    state.buffer.remove(0, size);
+    if (m_modes.isEmpty()) {
+      state.socket->write(header(NoSource, 0));
+      continue;
+    }
+    state.busy = true;
+    const QVector<Superposition::Mode> modes = m_modes;
+    QtConcurrent::run(&m_pool, [this, connection, modes, payload]() {
+      const int count = payload.size() / pointSize;
+      QVector<FieldPoint> points(count);
+      const char* data = payload.constData();
+      for (int i(0); i < count; i++) {
+        points[i].r = readFloat(data + i * pointSize);
+        points[i].theta = readFloat(data + i * pointSize + 4);
+        points[i].t = readFloat(data + i * pointSize + 8);
+      }
+      QVector<float> values(count);
+      m_solution->query(modes, points.constData(), values.data(), count);
+      QByteArray response = header(Ok, quint32(count));
+      response.resize(response.size() + count * int(sizeof(float)));
+      char* out = response.data() + replyHeaderSize;
+      for (int i(0); i < count; i++)
+        writeFloat(out + i * sizeof(float), values[i]);
+      QMetaObject::invokeMethod(this, "reply", Qt::QueuedConnection,
+                                Q_ARG(int, connection),
+                                Q_ARG(QByteArray, response));
+    });
+  }
+}
+
+void QueryServer::reply(int connection, const QByteArray& response) {
+  if (!m_connections.contains(connection)) return;
+  Connection& state = m_connections[connection];
+  state.socket->write(response);
+  state.busy = false;
+  processNext(connection);
+}
@@ -0,0 +1,91 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  QueryServer Class.
+  Point queries from other processes over a local socket.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef QUERYSERVER_H
+#define QUERYSERVER_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+#include "solution.h"
+#include "superposition.h"
+
+class QLocalServer;
+class QLocalSocket;
+
+// Answers point queries of other processes over a local socket (a named
+// pipe on Windows, a Unix domain socket elsewhere). All values are little
+// endian. A request is
+//   char[4] "CMQ1", quint32 count, count x (float r, float theta, float t)
+// and its reply
+//   char[4] "CMR1", quint32 status, quint32 count, count x float
+// with the displacement of the source at each point, as Solution::query.
+// The source is whatever setModes was last given: the displayed
+// superposition, t counting from the strike, or the current mode. A client
+// may send requests back to back without waiting; each connection gets
+// its replies in request order, and requests are evaluated off the GUI
+// thread. A request with a bad header or more than maximumCount points is
+// answered with BadRequest and the connection is closed.
+class QueryServer : public QObject {
+  Q_OBJECT
+
+ public:
+  enum Status { Ok, NoSource, BadRequest };
+
+  const static char* const defaultName;
+  const static quint32 maximumCount;
+
+  explicit QueryServer(const Solution* solution, QObject* parent = 0);
+  ~QueryServer();
+  bool listen(const QString& name);
+  QString errorString() const;
+  void setModes(const QVector<Superposition::Mode>& modes);
+
+ private Q_SLOTS:
+  void acceptConnections();
+  void reply(int connection, const QByteArray& response);
+
+ private:
+  struct Connection {
+    QLocalSocket* socket;
+    QByteArray buffer;
+    bool busy;
+  };
+  void receive(int connection);
+  void drop(int connection);
+  void processNext(int connection);
+  static QByteArray header(Status status, quint32 count);
+  const Solution* m_solution;
+  QLocalServer* m_server;
+  QVector<Superposition::Mode> m_modes;
+  QHash<int, Connection> m_connections;
+  int m_nextConnection;
+  QThreadPool m_pool;
+};
+
+#endif
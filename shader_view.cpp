@@ -0,0 +1,281 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  ShaderView Class.
+  OpenGL renderer animating the mode shape on the GPU.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "shader_view.h"
+#include <QtGui/QImage>
+#include <QtGui/QMouseEvent>
+#include <QtGui/QWheelEvent>
+#include <cmath>
+
+const float ShaderView::heightScale = 0.5f;
+
+namespace {
+const int floatsPerVertex = 5;
+}
+
+ShaderView::ShaderView(QWidget* parent)
+    : QOpenGLWidget(parent),
+      m_modeFieldChanged(false),
+      m_temporal(1.0f),
+      m_program(0),
+      m_texture(0),
+      m_vertices(QOpenGLBuffer::VertexBuffer),
+      m_indices(QOpenGLBuffer::IndexBuffer),
+      m_indexCount(0),
+      m_nodalRadius(0.0f),
+      m_nodalLinesChanged(false),
+      m_lineVertices(QOpenGLBuffer::VertexBuffer),
+      m_lineVertexCount(0),
+      m_yaw(30.0f),
+      m_pitch(30.0f),
+      m_distance(3.0f)
+{
+  setFocusPolicy(Qt::StrongFocus);
+}
+
+ShaderView::~ShaderView() {
+  makeCurrent();
+  delete m_texture;
+  delete m_program;
+  m_vertices.destroy();
+  m_indices.destroy();
+  m_lineVertices.destroy();
+  doneCurrent();
+}
+
+// The upload happens on the next paint, so fields installed while the view
+// is hidden cost nothing.
+void ShaderView::setModeField(const ModeField& mode_field) {
+  m_modeField = mode_field;
+  m_modeFieldChanged = true;
+  update();
+}
+
+void ShaderView::setTemporal(float temporal) {
+  m_temporal = temporal;
+  update();
+}
+
+void ShaderView::setNodalLines(const QVector<NodalLines::Polyline>& lines,
+                               float radius, const QColor& color) {
+  m_nodalLines = lines;
+  m_nodalRadius = radius;
+  m_nodalColor = color;
+  m_nodalLinesChanged = true;
+  update();
+}
+
+void ShaderView::initializeGL() {
+  initializeOpenGLFunctions();
+  m_program = new QOpenGLShaderProgram;
+  m_program->addShaderFromSourceFile(QOpenGLShader::Vertex,
+                                     ":/shaders/membrane.vert");
+  m_program->addShaderFromSourceFile(QOpenGLShader::Fragment,
+                                     ":/shaders/membrane.frag");
+  m_program->bindAttributeLocation("a_position", 0);
+  m_program->bindAttributeLocation("a_mode", 1);
+  if (!m_program->link())
+    qWarning("Cannot link the membrane shaders: %s",
+             qPrintable(m_program->log()));
+  m_texture = new QOpenGLTexture(QImage(":/maps/drumhead").mirrored());
+  m_texture->setMinificationFilter(QOpenGLTexture::LinearMipMapLinear);
+  m_texture->setMagnificationFilter(QOpenGLTexture::Linear);
+  m_vertices.create();
+  m_indices.create();
+  m_lineVertices.create();
+  m_modeFieldChanged = true;
+  m_nodalLinesChanged = true;
+}
+
+void ShaderView::resizeGL(int width, int height) {
+  m_projection.setToIdentity();
+  m_projection.perspective(45.0f, float(width) / qMax(1, height), 0.1f,
+                           100.0f);
+}
+
+// Vertices are (x, z, s, ds/dx, ds/dz) on the unit disk, s = R(r) Theta(theta).
+// The gradient, used for the normals, comes from central differences of the
+// separable factors: dR/dr along the rows, periodic dTheta/dtheta along the
+// columns, rotated into x and z.
+void ShaderView::uploadModeField() {
+  m_modeFieldChanged = false;
+  m_indexCount = 0;
+  const int rows = m_modeField.rowCount();
+  const int columns = m_modeField.columnCount();
+  if (m_modeField.isEmpty() || rows < 2 || columns < 3) return;
+  const float* radii = m_modeField.radii();
+  const float* radial = m_modeField.radial();
+  const float* thetas = m_modeField.thetas();
+  const float* angular = m_modeField.angular();
+  const float radius = radii[rows - 1];
+  if (radius <= 0.0f) return;
+
+  QVector<float> radialSlope(rows);
+  for (int j(0); j < rows; j++) {
+    int previous = qMax(0, j - 1);
+    int next = qMin(rows - 1, j + 1);
+    radialSlope[j] = radius * (radial[next] - radial[previous]) /
+                     (radii[next] - radii[previous]);
+  }
+  // The last column repeats the first at theta = 2 pi. Columns need not be
+  // evenly spaced, so the wrapped neighbours carry their own offsets.
+  const int period = columns - 1;
+  QVector<float> angularSlope(columns);
+  for (int k(0); k < columns; k++) {
+    int previous = (k + period - 1) % period;
+    int next = (k + 1) % period;
+    float span = thetas[next] - thetas[previous];
+    if (span <= 0.0f) span += thetas[period] - thetas[0];
+    angularSlope[k] = (angular[next] - angular[previous]) / span;
+  }
+
+  QVector<float> vertices(floatsPerVertex * rows * columns);
+  float* vertex = vertices.data();
+  for (int j(0); j < rows; j++) {
+    const float u = radii[j] / radius;
+    for (int k(0); k < columns; k++) {
+      const float c = std::cos(thetas[k]);
+      const float s = std::sin(thetas[k]);
+      const float du = radialSlope[j] * angular[k];
+      const float dtheta = u > 0.0f ? radial[j] * angularSlope[k] / u : 0.0f;
+      *vertex++ = u * c;
+      *vertex++ = u * s;
+      *vertex++ = radial[j] * angular[k];
+      *vertex++ = c * du - s * dtheta;
+      *vertex++ = s * du + c * dtheta;
+    }
+  }
+  QVector<GLuint> indices;
+  indices.reserve(6 * (rows - 1) * (columns - 1));
+  for (int j(0); j < rows - 1; j++) {
+    for (int k(0); k < columns - 1; k++) {
+      GLuint a = j * columns + k;
+      GLuint b = a + 1;
+      GLuint c = a + columns;
+      GLuint d = c + 1;
+      indices << a << c << b << b << c << d;
+    }
+  }
+  m_vertices.bind();
+  m_vertices.allocate(vertices.constData(),
+                      int(vertices.size() * sizeof(float)));
+  m_indices.bind();
+  m_indices.allocate(indices.constData(),
+                     int(indices.size() * sizeof(GLuint)));
+  m_indexCount = indices.size();
+}
+
+// Each step of a polyline becomes one GL_LINES pair, in the vertex layout
+// of the surface with a zero mode, so the same program draws them.
+void ShaderView::uploadNodalLines() {
+  m_nodalLinesChanged = false;
+  m_lineVertexCount = 0;
+  if (m_nodalLines.isEmpty() || m_nodalRadius <= 0.0f) return;
+  QVector<float> vertices;
+  for (const NodalLines::Polyline& line : m_nodalLines) {
+    for (int i(1); i < line.size(); i++) {
+      for (const NodalLines::Point& p : {line[i - 1], line[i]}) {
+        const float u = p.r / m_nodalRadius;
+        vertices << u * std::cos(p.theta) << u * std::sin(p.theta) << 0.0f
+                 << 0.0f << 0.0f;
+      }
+    }
+  }
+  m_lineVertices.bind();
+  m_lineVertices.allocate(vertices.constData(),
+                          int(vertices.size() * sizeof(float)));
+  m_lineVertexCount = vertices.size() / floatsPerVertex;
+}
+
+void ShaderView::paintGL() {
+  if (m_modeFieldChanged) uploadModeField();
+  if (m_nodalLinesChanged) uploadNodalLines();
+  glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  if (!m_indexCount || !m_program->isLinked()) return;
+  glEnable(GL_DEPTH_TEST);
+
+  QMatrix4x4 view;
+  view.translate(0.0f, 0.0f, -m_distance);
+  view.rotate(m_pitch, 1.0f, 0.0f, 0.0f);
+  view.rotate(m_yaw, 0.0f, 1.0f, 0.0f);
+
+  m_program->bind();
+  m_program->setUniformValue("u_mvp", m_projection * view);
+  m_program->setUniformValue("u_temporal", m_temporal);
+  m_program->setUniformValue("u_heightScale", heightScale);
+  m_program->setUniformValue("u_lightDirection",
+                             QVector3D(0.3f, 1.0f, 0.5f).normalized());
+  m_program->setUniformValue("u_texture", 0);
+  m_program->setUniformValue("u_overlay", QColor(Qt::transparent));
+  m_texture->bind(0);
+  m_vertices.bind();
+  m_program->enableAttributeArray(0);
+  m_program->enableAttributeArray(1);
+  m_program->setAttributeBuffer(0, GL_FLOAT, 0, 2,
+                                floatsPerVertex * sizeof(float));
+  m_program->setAttributeBuffer(1, GL_FLOAT, 2 * sizeof(float), 3,
+                                floatsPerVertex * sizeof(float));
+  m_indices.bind();
+  glEnable(GL_POLYGON_OFFSET_FILL);
+  glPolygonOffset(1.0f, 1.0f);
+  glDrawElements(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, 0);
+  glDisable(GL_POLYGON_OFFSET_FILL);
+  if (m_lineVertexCount) {
+    m_program->setUniformValue("u_overlay", m_nodalColor);
+    m_lineVertices.bind();
+    m_program->setAttributeBuffer(0, GL_FLOAT, 0, 2,
+                                  floatsPerVertex * sizeof(float));
+    m_program->setAttributeBuffer(1, GL_FLOAT, 2 * sizeof(float), 3,
+                                  floatsPerVertex * sizeof(float));
+    glLineWidth(2.0f);
+    glDrawArrays(GL_LINES, 0, m_lineVertexCount);
+  }
+  m_program->disableAttributeArray(0);
+  m_program->disableAttributeArray(1);
+  m_texture->release();
+  m_program->release();
+}
+
+void ShaderView::mousePressEvent(QMouseEvent* event) {
+  m_lastMousePosition = event->pos();
+}
+
+void ShaderView::mouseMoveEvent(QMouseEvent* event) {
+  if (!(event->buttons() & Qt::LeftButton)) return;
+  QPoint delta = event->pos() - m_lastMousePosition;
+  m_lastMousePosition = event->pos();
+  m_yaw += 0.5f * delta.x();
+  m_pitch = qBound(-89.0f, m_pitch + 0.5f * delta.y(), 89.0f);
+  update();
+}
+
+void ShaderView::wheelEvent(QWheelEvent* event) {
+  m_distance = qBound(1.2f,
+                      m_distance * std::pow(0.999f, float(event->angleDelta().y())),
+                      20.0f);
+  update();
+}
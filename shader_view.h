@@ -0,0 +1,94 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  ShaderView Class.
+  OpenGL renderer animating the mode shape on the GPU.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef SHADERVIEW_H
+#define SHADERVIEW_H
+
+#include <QtGui/QColor>
+#include <QtGui/QMatrix4x4>
+#include <QtGui/QOpenGLBuffer>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLShaderProgram>
+#include <QtGui/QOpenGLTexture>
+#include <QtWidgets/QOpenGLWidget>
+#include "mode_field.h"
+#include "nodal_lines.h"
+
+// Alternative to the Q3DSurface renderer. The spatial mode and its gradient
+// are uploaded to a vertex buffer once per mode; every frame after that
+// only sets the temporal factor uniform, so per frame traffic is a few
+// bytes whatever the resolution. Nodal lines of the mode are drawn as
+// lines at rest height, which they keep at every instant, and the surface
+// is pushed back in depth so they are not buried by a coarse mesh. Needs
+// OpenGL 2.1 or OpenGL ES 2.0 with 32 bit indices, which Mesa's software
+// rasterizers provide.
+class ShaderView : public QOpenGLWidget, protected QOpenGLFunctions {
+  Q_OBJECT
+
+ public:
+  const static float heightScale;
+
+  explicit ShaderView(QWidget* parent = 0);
+  ~ShaderView();
+  void setModeField(const ModeField& mode_field);
+  void setTemporal(float temporal);
+  // Lines with points within radius; no lines hides the overlay.
+  void setNodalLines(const QVector<NodalLines::Polyline>& lines, float radius,
+                     const QColor& color);
+
+ protected:
+  void initializeGL() override;
+  void resizeGL(int width, int height) override;
+  void paintGL() override;
+  void mousePressEvent(QMouseEvent* event) override;
+  void mouseMoveEvent(QMouseEvent* event) override;
+  void wheelEvent(QWheelEvent* event) override;
+
+ private:
+  void uploadModeField();
+  void uploadNodalLines();
+  ModeField m_modeField;
+  bool m_modeFieldChanged;
+  float m_temporal;
+  QOpenGLShaderProgram* m_program;
+  QOpenGLTexture* m_texture;
+  QOpenGLBuffer m_vertices;
+  QOpenGLBuffer m_indices;
+  int m_indexCount;
+  QVector<NodalLines::Polyline> m_nodalLines;
+  float m_nodalRadius;
+  QColor m_nodalColor;
+  bool m_nodalLinesChanged;
+  QOpenGLBuffer m_lineVertices;
+  int m_lineVertexCount;
+  QMatrix4x4 m_projection;
+  float m_yaw;
+  float m_pitch;
+  float m_distance;
+  QPoint m_lastMousePosition;
+};
+
+#endif
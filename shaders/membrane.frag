@@ -0,0 +1,17 @@
+#ifdef GL_ES
+precision mediump float;
+#endif
+
+uniform sampler2D u_texture;
+uniform vec3 u_lightDirection;
+// Flat colour over the shading, by its alpha; nodal lines use alpha 1.
+uniform vec4 u_overlay;
+varying vec2 v_texCoord;
+varying vec3 v_normal;
+
+void main() {
+  float diffuse = abs(dot(normalize(v_normal), u_lightDirection));
+  vec3 color = texture2D(u_texture, v_texCoord).rgb;
+  color *= 0.3 + 0.7 * diffuse;
+  gl_FragColor = vec4(mix(color, u_overlay.rgb, u_overlay.a), 1.0);
+}
@@ -0,0 +1,17 @@
+// Normal mode surface: the static mode shape s(x, z) and its gradient are
+// uploaded once; only the temporal factor cos(omega t) changes per frame.
+attribute vec2 a_position;  // x, z on the unit disk
+attribute vec3 a_mode;      // s, ds/dx, ds/dz
+uniform mat4 u_mvp;
+uniform float u_temporal;
+uniform float u_heightScale;
+varying vec2 v_texCoord;
+varying vec3 v_normal;
+
+void main() {
+  float height = u_heightScale * u_temporal;
+  v_texCoord = 0.5 * (a_position + 1.0);
+  v_normal = vec3(-height * a_mode.y, 1.0, -height * a_mode.z);
+  gl_Position =
+      u_mvp * vec4(a_position.x, height * a_mode.x, a_position.y, 1.0);
+}
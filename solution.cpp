@@ -27,7 +27,23 @@
 
 #include "solution.h"
 #include <QtCore/qmath.h>
-#include <boost/math/special_functions/bessel.hpp>
+#include <QtCore/QHash>
+#include <QtCore/QPair>
+#include <QtCore/QThread>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <queue>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "adaptive_grid.h"
+#include "bessel.h"
+#include "bessel_zeros.h"
+#include "metrics.h"
+#include "mode_kernels.h"
 
 using namespace QtDataVisualization;
 
@@ -36,46 +52,162 @@ const float Solution::sampleMaxTheta = 2 * M_PI;
 const float Solution::sampleMinR = 0.0f;
 const float Solution::sampleMinY = -1.0f;
 const float Solution::sampleMaxY = 1.0f;
+const double Solution::negligibleRadial = 1e-30;
+// Each table of a query chunk holds about this many floats at most, so a
+// chunk stays in cache whatever the number of modes.
+const int Solution::queryTableSize = 1 << 18;
+const int Solution::queryChunkMin = 64;
+const int Solution::queryChunkMax = 4096;
 
-Solution::Solution(int sampleCount, int timeSlicesCount, float radius,
-                   float wave_speed)
+namespace {
+
+// Radial chunks are about 1 / progressSteps of the rows, within these
+// bounds, so progress advances evenly however small the field.
+const int progressSteps = 20;
+const int radialChunkMin = 8;
+const int radialChunkMax = 256;
+
+quint32 floatBits(float value) {
+  quint32 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+// count is a multiple of 4.
+float dotProduct(const float* a, const float* b, int count) {
+#if defined(__SSE2__)
+  __m128 sum = _mm_setzero_ps();
+  for (int i = 0; i < count; i += 4)
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+  float lanes[4];
+  _mm_storeu_ps(lanes, sum);
+#else
+  float lanes[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  for (int i = 0; i < count; i += 4)
+    for (int k = 0; k < 4; k++) lanes[k] += a[i + k] * b[i + k];
+#endif
+  return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+}  // namespace
+
+Solution::Solution(int sampleCount, float radius, float wave_speed,
+                   const QString& cacheDirectory, bool initialMode)
     : m_radius(radius),
       m_wave_speed(wave_speed),
       m_sampleCount(sampleCount),
-      m_timeSlicesCount(timeSlicesCount),
+      m_samplingTolerance(0.0),
       m_sampleMaxR(radius),
       m_stepR{(radius - sampleMinR) / float(sampleCount - 1)},
       m_stepTheta{(sampleMaxTheta - sampleMinTheta) / float(sampleCount - 1)},
-      m_resetArray(0)
+      m_threadPool(new QThreadPool()),
+      m_diskCache(cacheDirectory.isEmpty() ? 0
+                                           : new ModeDiskCache(cacheDirectory))
 
 {
-  generateData(0.0, 1);
+  if (initialMode) generateData(0.0, 1);
 }
 
 Solution::~Solution() {
-  clearData();
+  m_threadPool->waitForDone();
+  delete m_threadPool;
+  delete m_diskCache;
 }
 
 float Solution::radius() const {
 return m_radius;
 }
 
-float Solution::radial_solution(float r, float bessel_root,
-                                int bessel_order_n) {
-  return boost::math::cyl_bessel_j(bessel_order_n,
-                                   (bessel_root / m_radius) * r);
+float Solution::waveSpeed() const {
+  return m_wave_speed;
+}
+
+void Solution::setSamplingTolerance(double tolerance) {
+  m_samplingTolerance = qMax(0.0, tolerance);
+  if (!m_modeField.isEmpty())
+    generateData(m_modeField.besselOrder(), m_modeField.rootOrder());
 }
 
-float Solution::angular_solution(float theta, float bessel_order_n) {
+double Solution::samplingTolerance() const {
+  return m_samplingTolerance;
+}
+
+int Solution::sampleCount() const {
+  return m_sampleCount;
+}
+
+// J_n(k r) for a run of ascending radial samples in one batch, through the
+// kernel specialized for n when there is one.
+// |J_n(x)| <= (x / 2)^n / n!, so the rows near the centre where that bound
+// is below negligibleRadial are flat zero and are not evaluated; for high
+// orders that is most of the membrane.
+void Solution::radial_solution(const float* radii, float bessel_root,
+                               int bessel_order_n, float* radial,
+                               int count) const {
+  const float k = bessel_root / m_radius;
+  int first = 0;
+  if (bessel_order_n > 0) {
+    const double n = bessel_order_n;
+    const double x0 =
+        2.0 * std::exp((std::lgamma(n + 1.0) + std::log(negligibleRadial)) / n);
+    first = int(std::lower_bound(radii, radii + count, float(x0 / k)) - radii);
+  }
+  std::fill(radial, radial + first, 0.0f);
+  if (first == count) return;
+  QVector<float> arguments(count - first);
+  for (int j(first); j < count; j++) arguments[j - first] = k * radii[j];
+  if (!mode_kernels::cyl_bessel_j(bessel_order_n, arguments.constData(),
+                                  radial + first, count - first))
+    bessel::cyl_bessel_j(bessel_order_n, arguments.constData(),
+                         radial + first, count - first);
+}
+
+float Solution::angular_solution(float theta, float bessel_order_n) const {
   return qCos(bessel_order_n * theta);
 }
 
-float Solution::temporal_solution(float t, float bessel_root) {
+// cos(n theta) on the uniform grid theta_k = 2 pi k / P, P = columns - 1.
+// For integer n the value depends only on n k mod P, which is a multiple of
+// g = gcd(n, P), and cos is even, so only the residues of the fundamental
+// sector [0, P / 2] are evaluated; every column is then a mirrored or
+// rotated copy. The reduction is exact, so high orders lose no accuracy
+// to a large float argument. The seam column theta = 2 pi maps to 0.
+void Solution::angular_samples(float bessel_order_n, float* angular,
+                               int count) const {
+  const int period = count - 1;
+  const int n = int(bessel_order_n);
+  if (period < 1 || n != bessel_order_n || n < 0) {
+    for (int j(0); j < count; j++)
+      angular[j] = angular_solution(
+          qMin(sampleMaxTheta, j * m_stepTheta + sampleMinTheta),
+          bessel_order_n);
+    return;
+  }
+  const int stride = n % period;
+  int g = period;
+  for (int a = stride; a;) {
+    int t = g % a;
+    g = a;
+    a = t;
+  }
+  QVector<float> sector(period / g / 2 + 1);
+  for (int i(0); i < sector.size(); i++)
+    sector[i] = float(std::cos(2.0 * M_PI * double(i) * g / period));
+  int residue = 0;
+  for (int j(0); j < count; j++) {
+    angular[j] = sector[qMin(residue, period - residue) / g];
+    residue += stride;
+    if (residue >= period) residue -= period;
+  }
+}
+
+float Solution::temporal_solution(float t, float bessel_root) const {
   return qCos(m_wave_speed * (bessel_root / m_radius) * t);
 }
 
-float Solution::get_bessel_root(float bessel_order_n, int root_order_m) {
-  return boost::math::cyl_bessel_j_zero(bessel_order_n, root_order_m);
+float Solution::get_bessel_root(float bessel_order_n,
+                                int root_order_m) const {
+  return BesselZeros::instance().zero(int(bessel_order_n), root_order_m);
 }
 
 float Solution::frequency(float bessel_order_n, int root_order_m) {
@@ -86,52 +218,496 @@ float Solution::frequency_ratio(float bessel_order_n, int root_order_m) {
   return frequency(bessel_order_n, root_order_m) / frequency(0.0, 1);
 }
 
+// f = j c / (2 pi R), so the cutoff maps to a root bound.
+QVector<ModeSpectrum::Entry> Solution::spectrum(double cutoff_frequency) const {
+  return ModeSpectrum::below(cutoff_frequency * 2 * M_PI * m_radius /
+                                 m_wave_speed,
+                             m_threadPool);
+}
+
 void Solution::generateData(float bessel_order_n, int root_order_m) {
-  if (!m_timeSlicesCount || !m_sampleCount) return;
-  clearData();
-  auto bessel_root = get_bessel_root(bessel_order_n, root_order_m);
-  const float sampleMinT = 0.0f;
-  const float sampleMaxT = (2 * M_PI * m_radius) / (m_wave_speed * bessel_root);
-  float stepT = (sampleMaxT - sampleMinT) / float(m_timeSlicesCount - 1);
-  m_timeSlices.reserve(m_timeSlicesCount);
-
-  QSurfaceDataArray base_surface_data_array;
-  for (int j(0); j < m_sampleCount; j++) {
-    QSurfaceDataRow* newRow = new QSurfaceDataRow(m_sampleCount);
-    float r = qMin(m_sampleMaxR, (j * m_stepR + sampleMinR));
-    auto radial = radial_solution(r, bessel_root, bessel_order_n);
-    int index = 0;
-    for (int k = 0; k < m_sampleCount; k++) {
-      float theta = qMin(sampleMaxTheta, (k * m_stepTheta + sampleMinTheta));
-      auto angular = angular_solution(theta, bessel_order_n);
-      auto z = radial * angular;
-      (*newRow)[index++].setPosition(QVector3D(theta, z, r));
+  m_modeField = loadModeField(bessel_order_n, root_order_m,
+                              ProgressCallback());
+}
+
+ModeKey Solution::modeKey(float bessel_order_n, int root_order_m) const {
+  ModeKey key = {bessel_order_n, root_order_m, m_sampleCount, m_radius,
+                 m_wave_speed, float(m_samplingTolerance)};
+  return key;
+}
+
+// Like computeModeField, but served from the disk cache when possible and
+// stored there once computed.
+ModeField Solution::loadModeField(float bessel_order_n, int root_order_m,
+                                  ProgressCallback progress,
+                                  QThreadPool* pool) const {
+  ModeField mode_field = cachedModeField(bessel_order_n, root_order_m);
+  if (!mode_field.isEmpty()) {
+    if (progress && !progress(100)) return ModeField();
+    return mode_field;
+  }
+  mode_field = computeModeField(bessel_order_n, root_order_m, progress, 1,
+                                ModeField(), pool);
+  storeModeField(mode_field);
+  return mode_field;
+}
+
+ModeField Solution::cachedModeField(float bessel_order_n,
+                                    int root_order_m) const {
+  if (!m_diskCache) return ModeField();
+  return m_diskCache->load(modeKey(bessel_order_n, root_order_m));
+}
+
+void Solution::storeModeField(const ModeField& mode_field) const {
+  if (!m_diskCache || mode_field.isEmpty()) return;
+  m_diskCache->store(
+      modeKey(mode_field.besselOrder(), mode_field.rootOrder()), mode_field);
+}
+
+// Indices 0, stride, 2 stride, ... and count - 1.
+QVector<int> Solution::subsample(int count, int stride) {
+  QVector<int> indices;
+  if (count < 1) return indices;
+  stride = qMax(1, stride);
+  indices.reserve((count - 1) / stride + 2);
+  for (int i(0); i < count; i += stride) indices.append(i);
+  if (indices.last() != count - 1) indices.append(count - 1);
+  return indices;
+}
+
+// Safe to call from worker threads: only reads the sampling parameters and
+// the shared Bessel zero table. Radial samples are computed in chunks
+// spread over the thread pool; the chunking depends on the row count alone,
+// not on the thread count, so the result is bit-identical to a single
+// threaded run.
+// Each factor is at most 1 in magnitude, so an adaptive grid gets half of
+// the tolerance per axis.
+// Subsampled fields take their rows and columns from the full grid, so
+// successive halvings of the stride end on exactly the full field. Only
+// the Bessel factor is worth reusing; the angular factor of the full grid
+// is cheap and is simply picked from.
+ModeField Solution::computeModeField(float bessel_order_n, int root_order_m,
+                                     ProgressCallback progress, int stride,
+                                     const ModeField& coarser,
+                                     QThreadPool* pool) const {
+  if (!m_sampleCount) return ModeField();
+  MetricsTimer timer(Metrics::Generation);
+  float bessel_root;
+  {
+    MetricsTimer rootTimer(Metrics::GenerationRoot);
+    bessel_root = get_bessel_root(bessel_order_n, root_order_m);
+  }
+
+  QVector<float> gridRadii;
+  QVector<float> gridThetas;
+  if (m_samplingTolerance > 0.0) {
+    gridRadii = AdaptiveGrid::radii(int(bessel_order_n), root_order_m,
+                                    m_radius, m_samplingTolerance / 2);
+    gridThetas =
+        AdaptiveGrid::thetas(bessel_order_n, m_samplingTolerance / 2);
+  } else {
+    gridRadii.resize(m_sampleCount);
+    gridThetas.resize(m_sampleCount);
+    for (int j(0); j < m_sampleCount; j++) {
+      gridRadii[j] = qMin(m_sampleMaxR, (j * m_stepR + sampleMinR));
+      gridThetas[j] = qMin(sampleMaxTheta, (j * m_stepTheta + sampleMinTheta));
+    }
+  }
+  QVector<float> gridAngular(gridThetas.size());
+  {
+    MetricsTimer angularTimer(Metrics::GenerationAngular);
+    if (m_samplingTolerance > 0.0) {
+      for (int k(0); k < gridThetas.size(); k++)
+        gridAngular[k] = float(std::cos(double(bessel_order_n) * gridThetas[k]));
+    } else {
+      angular_samples(bessel_order_n, gridAngular.data(), gridAngular.size());
     }
-    base_surface_data_array << newRow;
   }
-  // Populate time slices
-  for (int i(0); i < m_timeSlicesCount; i++) {
-    float t = qMin(sampleMaxT, (i * stepT + sampleMinT));
-    auto temporal = temporal_solution(t, bessel_root);
-    auto modifier = [&temporal](QSurfaceDataItem& item) -> void {
-      item.setY(temporal * item.y());
-    };
-    auto slice = newSurfaceDataArrayFromSource(base_surface_data_array, modifier);
-    m_timeSlices << *slice;
-    delete slice;
-  }  // slices
 
-  clearSurfaceDataArray(base_surface_data_array);
+  const QVector<int> rows = subsample(gridRadii.size(), stride);
+  const QVector<int> columns = subsample(gridThetas.size(), stride);
+  const int rowCount = rows.size();
+  const int columnCount = columns.size();
+  QVector<float> radii(rowCount);
+  QVector<float> radial(rowCount);
+  QVector<float> thetas(columnCount);
+  QVector<float> angular(columnCount);
+  for (int k(0); k < columnCount; k++) {
+    thetas[k] = gridThetas[columns[k]];
+    angular[k] = gridAngular[columns[k]];
+  }
+  // Rows of coarser are the rows at a multiple of 2 stride, and the last.
+  const bool reuse =
+      !coarser.isEmpty() && coarser.besselOrder() == bessel_order_n &&
+      coarser.rootOrder() == root_order_m &&
+      coarser.rowCount() == subsample(gridRadii.size(), 2 * stride).size();
+  QVector<int> fresh;
+  for (int j(0); j < rowCount; j++) {
+    radii[j] = gridRadii[rows[j]];
+    if (reuse && j == rowCount - 1)
+      radial[j] = coarser.radial()[coarser.rowCount() - 1];
+    else if (reuse && rows[j] % (2 * stride) == 0)
+      radial[j] = coarser.radial()[rows[j] / (2 * stride)];
+    else
+      fresh.append(j);
+  }
+
+  // The fresh rows ascend, so they can be evaluated as one batch.
+  const int freshCount = fresh.size();
+  QVector<float> freshRadii(freshCount);
+  QVector<float> freshRadial(freshCount);
+  for (int i(0); i < freshCount; i++) freshRadii[i] = radii[fresh[i]];
+  const float* radiiData = freshRadii.constData();
+  float* radialData = freshRadial.data();
+  const int chunk =
+      qBound(radialChunkMin, (freshCount + progressSteps - 1) / progressSteps,
+             radialChunkMax);
+  const int chunks = (freshCount + chunk - 1) / chunk;
+  std::atomic<int> done{0};
+  std::atomic<bool> cancelled{false};
+  parallelFor(pool ? pool : m_threadPool, chunks, [&](int c) {
+    if (cancelled) return;
+    int first = c * chunk;
+    int last = qMin(first + chunk, freshCount);
+    {
+      MetricsTimer radialTimer(Metrics::GenerationRadial);
+      radial_solution(radiiData + first, bessel_root, bessel_order_n,
+                      radialData + first, last - first);
+    }
+    if (progress && !progress(99 * ++done / chunks)) cancelled = true;
+  });
+  if (cancelled || (progress && !progress(100))) return ModeField();
+  for (int i(0); i < freshCount; i++) radial[fresh[i]] = freshRadial[i];
+  return ModeField(bessel_order_n, root_order_m, bessel_root,
+                   radii, radial, thetas, angular);
 }
 
-QVector<QSurfaceDataArray>& Solution::getTimeSlices() {
-  return m_timeSlices;
+// The modeCount lowest frequency modes excited by a Gaussian mallet profile
+// G. With rho = r / R and psi = theta - theta0, G only depends on cos psi,
+// so only cos(n psi) terms appear and the Fourier-Bessel coefficients are
+//   c_nm = int G J_n(j_nm rho) cos(n psi) rho drho dpsi
+//          / (eps_n pi J_{n+1}(j_nm)^2 / 2),  eps_0 = 2, eps_n = 1.
+// The integral is a midpoint rule in rho and a trapezoid rule in psi, both
+// fine enough to resolve the mallet and the fastest mode. Pluck uses c_nm
+// as the cosine amplitude, strike c_nm / w_nm as the sine amplitude.
+// Modes come back grouped by order, in increasing n and m. Progress runs
+// from 0 to 70.
+QVector<Superposition::Mode> Solution::strikeModes(
+    const StrikeCondition& strike, int modeCount,
+    ProgressCallback progress) const {
+  if (modeCount < 1 || strike.width <= 0.0f)
+    return QVector<Superposition::Mode>();
+
+  // Lowest roots first: (n, m + 1) and, for m = 1, (n + 1, 1) follow (n, m).
+  QVector<Superposition::Mode> modes;
+  {
+    MetricsTimer rootTimer(Metrics::GenerationRoot);
+    typedef QPair<double, QPair<int, int> > Candidate;
+    std::priority_queue<Candidate, std::vector<Candidate>,
+                        std::greater<Candidate> > candidates;
+    candidates.push(qMakePair(double(get_bessel_root(0, 1)), qMakePair(0, 1)));
+    while (modes.size() < modeCount && !candidates.empty()) {
+      Candidate candidate = candidates.top();
+      candidates.pop();
+      int n = candidate.second.first;
+      int m = candidate.second.second;
+      Superposition::Mode mode = {float(n), m, float(candidate.first),
+                                  m_wave_speed * candidate.first / m_radius,
+                                  0.0f, 0.0f, strike.angle};
+      modes.append(mode);
+      if (m < BesselZeros::maxRoot)
+        candidates.push(qMakePair(double(get_bessel_root(n, m + 1)),
+                                  qMakePair(n, m + 1)));
+      if (m == 1 && n < BesselZeros::maxOrder)
+        candidates.push(qMakePair(double(get_bessel_root(n + 1, 1)),
+                                  qMakePair(n + 1, 1)));
+    }
+    std::sort(modes.begin(), modes.end(),
+              [](const Superposition::Mode& a, const Superposition::Mode& b) {
+                return a.bessel_order_n < b.bessel_order_n ||
+                       (a.bessel_order_n == b.bessel_order_n &&
+                        a.root_order_m < b.root_order_m);
+              });
+  }
+  QVector<float> orders;
+  QVector<int> orderOfMode(modes.size());
+  float maxRoot = 0.0f;
+  for (int i(0); i < modes.size(); i++) {
+    if (orders.isEmpty() || orders.last() != modes[i].bessel_order_n)
+      orders.append(modes[i].bessel_order_n);
+    orderOfMode[i] = orders.size() - 1;
+    maxRoot = qMax(maxRoot, modes[i].bessel_root);
+  }
+  if (progress && !progress(10)) return QVector<Superposition::Mode>();
+
+  // Angular projections g_n(rho_i) = int G(rho_i, psi) cos(n psi) dpsi.
+  const double width = strike.width;
+  const double position = strike.position;
+  const int radialNodes =
+      qBound(256, int(qMax(8.0 * maxRoot, 8.0 / width)), 4096);
+  const int angularNodes = qBound(
+      256, int(qMax(4.0 * orders.last() + 8, 8 * M_PI * position / width)),
+      8192);
+  const double dRho = 1.0 / radialNodes;
+  const double dPsi = 2 * M_PI / angularNodes;
+  QVector<double> cosines(orders.size() * angularNodes);
+  for (int o(0); o < orders.size(); o++)
+    for (int k(0); k < angularNodes; k++)
+      cosines[o * angularNodes + k] = std::cos(orders[o] * k * dPsi);
+  QVector<double> projections(orders.size() * radialNodes, 0.0);
+  const int chunk = 16;
+  parallelFor(m_threadPool, (radialNodes + chunk - 1) / chunk, [&](int c) {
+    QVector<double> profile(angularNodes);
+    for (int i = c * chunk; i < qMin(radialNodes, (c + 1) * chunk); i++) {
+      const double rho = (i + 0.5) * dRho;
+      if (std::fabs(rho - position) > 8 * width) continue;
+      for (int k(0); k < angularNodes; k++) {
+        double distance2 = rho * rho + position * position -
+                           2 * rho * position * std::cos(k * dPsi);
+        profile[k] = std::exp(-distance2 / (2 * width * width));
+      }
+      for (int o(0); o < orders.size(); o++) {
+        const double* cosine = cosines.constData() + o * angularNodes;
+        double sum = 0.0;
+        for (int k(0); k < angularNodes; k++) sum += profile[k] * cosine[k];
+        projections[o * radialNodes + i] = sum * dPsi;
+      }
+    }
+  });
+  if (progress && !progress(40)) return QVector<Superposition::Mode>();
+
+  // Radial quadrature, one mode per task.
+  parallelFor(m_threadPool, modes.size(), [&](int i) {
+    Superposition::Mode& mode = modes[i];
+    const int n = int(mode.bessel_order_n);
+    QVector<double> arguments(radialNodes);
+    QVector<double> values(radialNodes);
+    for (int r(0); r < radialNodes; r++)
+      arguments[r] = mode.bessel_root * (r + 0.5) * dRho;
+    bessel::cyl_bessel_j(n, arguments.constData(), values.data(),
+                         radialNodes);
+    const double* projection =
+        projections.constData() + orderOfMode[i] * radialNodes;
+    double sum = 0.0;
+    for (int r(0); r < radialNodes; r++)
+      sum += projection[r] * values[r] * (r + 0.5) * dRho;
+    double next = bessel::cyl_bessel_j(n + 1, mode.bessel_root);
+    double norm = (n ? 1.0 : 2.0) * M_PI * next * next / 2;
+    double coefficient = sum * dRho / norm;
+    if (strike.excitation == StrikeCondition::Pluck)
+      mode.cosine = float(coefficient);
+    else
+      mode.sine = float(coefficient / mode.omega);
+  });
+  if (progress && !progress(70)) return QVector<Superposition::Mode>();
+  return modes;
+}
+
+// The strike modes on the display grid, scaled to a unit peak over one
+// period of the lowest mode.
+Superposition Solution::computeSuperposition(const StrikeCondition& strike,
+                                             int modeCount,
+                                             ProgressCallback progress) const {
+  if (!m_sampleCount) return Superposition();
+  MetricsTimer timer(Metrics::Generation);
+  QVector<Superposition::Mode> modes =
+      strikeModes(strike, modeCount, progress);
+  if (modes.isEmpty()) return Superposition();
+  QVector<float> orders;
+  for (const Superposition::Mode& mode : modes)
+    if (orders.isEmpty() || orders.last() != mode.bessel_order_n)
+      orders.append(mode.bessel_order_n);
+
+  // Display tables on the grid of computeModeField.
+  QVector<float> radii(m_sampleCount);
+  QVector<float> thetas(m_sampleCount);
+  for (int j(0); j < m_sampleCount; j++) {
+    radii[j] = qMin(m_sampleMaxR, (j * m_stepR + sampleMinR));
+    thetas[j] = qMin(sampleMaxTheta, (j * m_stepTheta + sampleMinTheta));
+  }
+  QVector<float> radial(m_sampleCount * modes.size());
+  parallelFor(m_threadPool, modes.size(), [&](int i) {
+    MetricsTimer radialTimer(Metrics::GenerationRadial);
+    QVector<float> values(m_sampleCount);
+    radial_solution(radii.constData(), modes[i].bessel_root,
+                    int(modes[i].bessel_order_n), values.data(),
+                    m_sampleCount);
+    for (int j(0); j < m_sampleCount; j++)
+      radial[j * modes.size() + i] = values[j];
+  });
+  QVector<float> angular(orders.size() * m_sampleCount);
+  {
+    MetricsTimer angularTimer(Metrics::GenerationAngular);
+    for (int o(0); o < orders.size(); o++)
+      for (int k(0); k < m_sampleCount; k++)
+        angular[o * m_sampleCount + k] =
+            angular_solution(thetas[k] - strike.angle, orders[o]);
+  }
+  if (progress && !progress(95)) return Superposition();
+
+  Superposition superposition(m_sampleCount, m_sampleCount, radii, thetas,
+                              modes, orders, radial, angular);
+  double lowest = modes[0].omega;
+  for (const Superposition::Mode& mode : modes) lowest = qMin(lowest, mode.omega);
+  float peak = superposition.peakDisplacement(2 * M_PI / lowest, 16);
+  if (peak > 0.0f) superposition.scale(1.0f / peak);
+  if (progress && !progress(100)) return Superposition();
+  return superposition;
+}
+
+void Solution::setModeField(const ModeField& mode_field) {
+  m_modeField = mode_field;
+}
+
+// Threads used by computeModeField; 0 or less means one per core.
+void Solution::setThreadCount(int count) {
+  m_threadPool->setMaxThreadCount(count > 0 ? count
+                                            : QThread::idealThreadCount());
+}
+
+int Solution::threadCount() const {
+  return m_threadPool->maxThreadCount();
+}
+
+QThreadPool* Solution::threadPool() const {
+  return m_threadPool;
 }
 
-void Solution::clearData() {
-  for (int i(0); i < m_timeSlices.size(); i++) {
-     QSurfaceDataArray& array = m_timeSlices[i];
-     clearSurfaceDataArray(array);
+const ModeField& Solution::modeField() const {
+  return m_modeField;
+}
+
+// Period in seconds of the current mode, 2 pi / omega.
+double Solution::period() const {
+  return (2 * M_PI * m_radius) / (m_wave_speed * m_modeField.besselRoot());
+}
+
+// The temporal factor cos(omega t) of the current mode at time t seconds;
+// a frame is the mode field scaled by it.
+float Solution::temporalAt(double t) const {
+  return temporal_solution(float(std::fmod(t, period())),
+                           m_modeField.besselRoot());
+}
+
+Superposition::Mode Solution::currentMode() const {
+  const float root = m_modeField.besselRoot();
+  Superposition::Mode mode = {m_modeField.besselOrder(),
+                              m_modeField.rootOrder(),
+                              root,
+                              m_wave_speed * double(root) / m_radius,
+                              1.0f,
+                              0.0f,
+                              0.0f};
+  return mode;
+}
+
+void Solution::query(const FieldPoint* points, float* out, int count) const {
+  query(QVector<Superposition::Mode>() << currentMode(), points, out, count);
+}
+
+// Points are split into chunks that are evaluated in parallel.
+void Solution::query(const QVector<Superposition::Mode>& modes,
+                     const FieldPoint* points, float* out, int count) const {
+  if (count <= 0) return;
+  if (modes.isEmpty()) {
+    std::fill(out, out + count, 0.0f);
+    return;
+  }
+  MetricsTimer timer(Metrics::Query);
+  const int width = (modes.size() + 3) & ~3;
+  const int chunk =
+      qBound(queryChunkMin, queryTableSize / width, queryChunkMax);
+  parallelFor(m_threadPool, (count + chunk - 1) / chunk, [&](int c) {
+    const int first = c * chunk;
+    query_chunk(modes, points + first, out + first,
+                qMin(chunk, count - first));
+  });
+}
+
+// z = sum_i S_i(r, theta) T_i(t) with S_i = J_n(k r) cos(n (theta - theta0))
+// and T_i = A_i cos w_i t + B_i sin w_i t. Sensors are usually read at a
+// few places over many instants, or at many places at a few instants, so
+// S is tabulated once per distinct place of the chunk and T once per
+// distinct instant, each row padded to a multiple of 4 modes; a point is
+// then the dot product of its two rows. The radial factors of a mode are
+// one batch over the distinct radii in ascending order.
+void Solution::query_chunk(const QVector<Superposition::Mode>& modes,
+                           const FieldPoint* points, float* out,
+                           int count) const {
+  const int modeCount = modes.size();
+  const int width = (modeCount + 3) & ~3;
+  QHash<quint64, int> placeIndex;
+  QHash<quint32, int> instantIndex;
+  QVector<int> places(count);
+  QVector<int> instants(count);
+  QVector<float> radii;
+  QVector<float> thetas;
+  QVector<double> times;
+  for (int p(0); p < count; p++) {
+    const FieldPoint& point = points[p];
+    if (!(point.r >= 0.0f && point.r <= m_radius) ||
+        !std::isfinite(point.theta) || !std::isfinite(point.t)) {
+      places[p] = -1;
+      continue;
+    }
+    const quint64 key =
+        (quint64(floatBits(point.r)) << 32) | floatBits(point.theta);
+    int place = placeIndex.value(key, -1);
+    if (place < 0) {
+      place = radii.size();
+      placeIndex.insert(key, place);
+      radii.append(point.r);
+      thetas.append(point.theta);
+    }
+    int instant = instantIndex.value(floatBits(point.t), -1);
+    if (instant < 0) {
+      instant = times.size();
+      instantIndex.insert(floatBits(point.t), instant);
+      times.append(point.t);
+    }
+    places[p] = place;
+    instants[p] = instant;
   }
-  m_timeSlices.erase(m_timeSlices.begin(), m_timeSlices.end());
+
+  const int placeCount = radii.size();
+  QVector<int> order(placeCount);
+  for (int u(0); u < placeCount; u++) order[u] = u;
+  std::sort(order.begin(), order.end(),
+            [&radii](int a, int b) { return radii[a] < radii[b]; });
+  QVector<float> sortedRadii(placeCount);
+  for (int j(0); j < placeCount; j++) sortedRadii[j] = radii[order[j]];
+
+  QVector<float> spatial(placeCount * width, 0.0f);
+  QVector<float> radial(placeCount);
+  QVector<float> angular(placeCount);
+  for (int i(0); i < modeCount && placeCount; i++) {
+    const Superposition::Mode& mode = modes[i];
+    radial_solution(sortedRadii.constData(), mode.bessel_root,
+                    int(mode.bessel_order_n), radial.data(), placeCount);
+    // Modes of one order share the angular factors.
+    if (i == 0 || mode.bessel_order_n != modes[i - 1].bessel_order_n ||
+        mode.angle != modes[i - 1].angle)
+      for (int u(0); u < placeCount; u++)
+        angular[u] = float(std::cos(double(mode.bessel_order_n) *
+                                    (double(thetas[u]) - mode.angle)));
+    for (int j(0); j < placeCount; j++)
+      spatial[order[j] * width + i] = radial[j] * angular[order[j]];
+  }
+
+  const int instantCount = times.size();
+  QVector<float> temporal(instantCount * width, 0.0f);
+  for (int v(0); v < instantCount; v++)
+    for (int i(0); i < modeCount; i++) {
+      const Superposition::Mode& mode = modes[i];
+      const double phase = std::fmod(mode.omega * times[v], 2 * M_PI);
+      temporal[v * width + i] = float(mode.cosine * std::cos(phase) +
+                                      mode.sine * std::sin(phase));
+    }
+
+  for (int p(0); p < count; p++)
+    out[p] = places[p] < 0
+                 ? 0.0f
+                 : dotProduct(spatial.constData() + places[p] * width,
+                              temporal.constData() + instants[p] * width,
+                              width);
 }
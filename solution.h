@@ -28,12 +28,30 @@
 #define SOLUTION_H
 
 #include <QtCore/qmath.h>
+#include <QtCore/QThreadPool>
 #include <QtDataVisualization/QSurface3DSeries>
+#include <functional>
+#include "mode_cache.h"
+#include "mode_field.h"
+#include "mode_spectrum.h"
 #include "qt_helpers.h"
+#include "superposition.h"
 
 using namespace QtDataVisualization;
 using namespace qt_helpers;
 
+// Reports generation progress in percent; returning false cancels it.
+// May be called from any of the generation threads.
+typedef std::function<bool(int)> ProgressCallback;
+
+// A point of the field: radius r and angle theta on the membrane, time t
+// in seconds.
+struct FieldPoint {
+  float r;
+  float theta;
+  float t;
+};
+
 class Solution  {
  public:
   const static float sampleMinTheta;
@@ -41,30 +59,89 @@ class Solution  {
   const static float sampleMinY;
   const static float sampleMaxY;
   const static float sampleMinR;
+  const static double negligibleRadial;
+  const static int queryTableSize;
+  const static int queryChunkMin;
+  const static int queryChunkMax;
 
-  explicit Solution(int sampleCount, int timeSlicesCount, float radius,
-      float wave_speed);
+  // Starts on mode (0, 1) unless initialMode is false, for solutions that
+  // only serve computeModeField; modeField() is then empty.
+  explicit Solution(int sampleCount, float radius, float wave_speed,
+                    const QString& cacheDirectory = QString(),
+                    bool initialMode = true);
   virtual ~Solution();
   void generateData(float bessel_order_n, int root_order_m);
+  // With stride above 1 only every stride-th row and column of the grid
+  // is sampled, the last ones always included. Samples of coarser, the
+  // same mode at twice the stride, are reused instead of evaluated again.
+  // The work is spread over pool, by default threadPool().
+  ModeField computeModeField(float bessel_order_n, int root_order_m,
+                             ProgressCallback progress, int stride = 1,
+                             const ModeField& coarser = ModeField(),
+                             QThreadPool* pool = 0) const;
+  ModeField loadModeField(float bessel_order_n, int root_order_m,
+                          ProgressCallback progress,
+                          QThreadPool* pool = 0) const;
+  // The disk cache alone: an empty field when the mode is not stored.
+  ModeField cachedModeField(float bessel_order_n, int root_order_m) const;
+  void storeModeField(const ModeField& mode_field) const;
+  static QVector<int> subsample(int count, int stride);
+  QVector<Superposition::Mode> strikeModes(const StrikeCondition& strike,
+                                          int modeCount,
+                                          ProgressCallback progress) const;
+  Superposition computeSuperposition(const StrikeCondition& strike,
+                                     int modeCount,
+                                     ProgressCallback progress) const;
+  ModeKey modeKey(float bessel_order_n, int root_order_m) const;
+  void setModeField(const ModeField& mode_field);
+  void setThreadCount(int count);
+  int threadCount() const;
+  // The pool of computeModeField, for other parallel work on the fields.
+  QThreadPool* threadPool() const;
+  // Above 0, mode fields are sampled on an AdaptiveGrid whose piecewise
+  // linear surface stays within tolerance of the mode (peak 1) instead of
+  // on the uniform sampleCount grid. Regenerates the current mode, if any;
+  // not to be called while modes are generated on other threads.
+  void setSamplingTolerance(double tolerance);
+  double samplingTolerance() const;
+  int sampleCount() const;
   float frequency(float bessel_order_n, int root_order_m);
   float frequency_ratio(float bessel_order_n, int root_order_m);
+  QVector<ModeSpectrum::Entry> spectrum(double cutoff_frequency) const;
   float radius() const;
-  QVector<QSurfaceDataArray>& getTimeSlices();
+  float waveSpeed() const;
+  const ModeField& modeField() const;
+  double period() const;
+  float temporalAt(double t) const;
+  // The current mode as a single term of unit cosine amplitude.
+  Superposition::Mode currentMode() const;
+  // Displacement at each of count points, of the current mode or of the
+  // sum of modes, e.g. those of a Superposition, into out. Points off the
+  // membrane are 0. The second form is safe from any thread.
+  void query(const FieldPoint* points, float* out, int count) const;
+  void query(const QVector<Superposition::Mode>& modes,
+             const FieldPoint* points, float* out, int count) const;
  private:
-  void clearData();
-  float get_bessel_root(float bessel_order_n, int root_order_m);
-  float radial_solution(float r, float bessel_root, int bessel_order_n);
-  float angular_solution(float theta, float bessel_order_n);
-  float temporal_solution(float t, float bessel_root);
+  friend class Benchmark;
+  float get_bessel_root(float bessel_order_n, int root_order_m) const;
+  void radial_solution(const float* radii, float bessel_root,
+                       int bessel_order_n, float* radial, int count) const;
+  float angular_solution(float theta, float bessel_order_n) const;
+  void angular_samples(float bessel_order_n, float* angular,
+                       int count) const;
+  float temporal_solution(float t, float bessel_root) const;
+  void query_chunk(const QVector<Superposition::Mode>& modes,
+                   const FieldPoint* points, float* out, int count) const;
   float m_radius;
   float m_wave_speed;
   int m_sampleCount;
-  int m_timeSlicesCount;
+  double m_samplingTolerance;
   float m_sampleMaxR;
   float m_stepR;
   float m_stepTheta;
-  QVector<QSurfaceDataArray> m_timeSlices;
-  QSurfaceDataArray* m_resetArray;
+  ModeField m_modeField;
+  QThreadPool* m_threadPool;
+  ModeDiskCache* m_diskCache;
 };
 
 #endif
@@ -0,0 +1,209 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  SpectrumPanel Class.
+  Sorted, filterable table of the modes below a cutoff.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "spectrum_panel.h"
+#include <QtWidgets/QFormLayout>
+#include <QtWidgets/QHeaderView>
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QVBoxLayout>
+#include "bessel_zeros.h"
+
+const double SpectrumPanel::defaultCutoffRatio = 20.0;
+
+SpectrumModel::SpectrumModel(QObject* parent)
+    : QAbstractTableModel(parent),
+      m_fundamentalFrequency(1.0),
+      m_fundamentalRoot(BesselZeros::instance().zero(0, 1))
+{
+}
+
+void SpectrumModel::setSpectrum(const QVector<ModeSpectrum::Entry>& spectrum,
+                                double fundamental_frequency) {
+  beginResetModel();
+  m_spectrum = spectrum;
+  m_fundamentalFrequency = fundamental_frequency;
+  endResetModel();
+}
+
+const ModeSpectrum::Entry& SpectrumModel::entry(int row) const {
+  return m_spectrum.at(row);
+}
+
+int SpectrumModel::rowCount(const QModelIndex& parent) const {
+  return parent.isValid() ? 0 : m_spectrum.size();
+}
+
+int SpectrumModel::columnCount(const QModelIndex& parent) const {
+  return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant SpectrumModel::data(const QModelIndex& index, int role) const {
+  if (!index.isValid() || index.row() >= m_spectrum.size()) return QVariant();
+  const ModeSpectrum::Entry& entry = m_spectrum.at(index.row());
+  const double ratio = entry.bessel_root / m_fundamentalRoot;
+  if (role == Qt::TextAlignmentRole)
+    return int(Qt::AlignRight | Qt::AlignVCenter);
+  if (role != Qt::DisplayRole && role != Qt::UserRole) return QVariant();
+  const bool display = role == Qt::DisplayRole;
+  switch (index.column()) {
+    case OrderColumn: return entry.bessel_order_n;
+    case RootColumn: return entry.root_order_m;
+    case BesselRootColumn:
+      return display ? QVariant(QString::number(entry.bessel_root, 'f', 4))
+                     : QVariant(entry.bessel_root);
+    case FrequencyColumn:
+      return display ? QVariant(QString::number(
+                           ratio * m_fundamentalFrequency, 'f', 3))
+                     : QVariant(ratio * m_fundamentalFrequency);
+    case RatioColumn:
+      return display ? QVariant(QString::number(ratio, 'f', 4))
+                     : QVariant(ratio);
+  }
+  return QVariant();
+}
+
+QVariant SpectrumModel::headerData(int section, Qt::Orientation orientation,
+                                   int role) const {
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    return QVariant();
+  switch (section) {
+    case OrderColumn: return QStringLiteral("n");
+    case RootColumn: return QStringLiteral("m");
+    case BesselRootColumn: return QStringLiteral("j(n, m)");
+    case FrequencyColumn: return QStringLiteral("f (Hz)");
+    case RatioColumn: return QStringLiteral("f / f(0, 1)");
+  }
+  return QVariant();
+}
+
+SpectrumFilter::SpectrumFilter(QObject* parent)
+    : QSortFilterProxyModel(parent),
+      m_order(-1),
+      m_root(-1)
+{
+  setSortRole(Qt::UserRole);
+}
+
+void SpectrumFilter::setOrder(int bessel_order_n) {
+  m_order = bessel_order_n;
+  invalidateFilter();
+}
+
+void SpectrumFilter::setRoot(int root_order_m) {
+  m_root = root_order_m;
+  invalidateFilter();
+}
+
+bool SpectrumFilter::filterAcceptsRow(int sourceRow,
+                                      const QModelIndex&) const {
+  const ModeSpectrum::Entry& entry =
+      static_cast<SpectrumModel*>(sourceModel())->entry(sourceRow);
+  return (m_order < 0 || entry.bessel_order_n == m_order) &&
+         (m_root < 0 || entry.root_order_m == m_root);
+}
+
+SpectrumPanel::SpectrumPanel(Solution* solution, ModeGenerator* generator,
+                             QWidget* parent)
+    : QGroupBox(QStringLiteral("Spectrum"), parent),
+      m_solution(solution),
+      m_generator(generator)
+{
+  const double fundamental = m_solution->frequency(0.0f, 1);
+  m_cutoff = new QDoubleSpinBox(this);
+  m_cutoff->setRange(fundamental, fundamental * ModeSpectrum::maximumRoot /
+                                      BesselZeros::instance().zero(0, 1));
+  m_cutoff->setDecimals(2);
+  m_cutoff->setValue(defaultCutoffRatio * fundamental);
+  m_cutoff->setSuffix(" Hz");
+
+  QSpinBox* order = new QSpinBox(this);
+  order->setRange(-1, BesselZeros::maxOrder);
+  order->setValue(-1);
+  order->setSpecialValueText(QStringLiteral("Any"));
+
+  QSpinBox* root = new QSpinBox(this);
+  root->setRange(-1, BesselZeros::maxRoot);
+  root->setValue(-1);
+  root->setSpecialValueText(QStringLiteral("Any"));
+
+  QPushButton* listButton = new QPushButton("&List Modes", this);
+  m_summary = new QLabel(this);
+
+  m_model = new SpectrumModel(this);
+  m_filter = new SpectrumFilter(this);
+  m_filter->setSourceModel(m_model);
+  m_table = new QTableView(this);
+  m_table->setModel(m_filter);
+  m_table->setSortingEnabled(true);
+  m_table->sortByColumn(SpectrumModel::RatioColumn, Qt::AscendingOrder);
+  m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+  m_table->setSelectionMode(QAbstractItemView::SingleSelection);
+  m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  m_table->verticalHeader()->setVisible(false);
+  m_table->verticalHeader()->setDefaultSectionSize(
+      m_table->fontMetrics().height() + 4);
+  m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+
+  QFormLayout* form = new QFormLayout;
+  form->addRow(QStringLiteral("Cutoff"), m_cutoff);
+  form->addRow(QStringLiteral("Order n"), order);
+  form->addRow(QStringLiteral("Root m"), root);
+  QVBoxLayout* vBox = new QVBoxLayout;
+  vBox->addLayout(form);
+  vBox->addWidget(listButton);
+  vBox->addWidget(m_summary);
+  vBox->addWidget(m_table, 1);
+  setLayout(vBox);
+
+  connect(listButton, &QPushButton::clicked, this, &SpectrumPanel::listModes);
+  connect(order, SIGNAL(valueChanged(int)), m_filter, SLOT(setOrder(int)));
+  connect(root, SIGNAL(valueChanged(int)), m_filter, SLOT(setRoot(int)));
+  connect(m_table->selectionModel(), &QItemSelectionModel::currentRowChanged,
+          this, &SpectrumPanel::selectRow);
+  connect(m_generator, &ModeGenerator::spectrumReady,
+          this, &SpectrumPanel::showSpectrum);
+  listModes();
+}
+
+void SpectrumPanel::listModes() {
+  m_summary->setText(QStringLiteral("Listing modes..."));
+  m_generator->requestSpectrum(m_cutoff->value());
+}
+
+void SpectrumPanel::showSpectrum(const QVector<ModeSpectrum::Entry>& spectrum,
+                                 qint64 elapsed) {
+  m_model->setSpectrum(spectrum, m_solution->frequency(0.0f, 1));
+  m_summary->setText(QString("%1 modes in %2 ms")
+                         .arg(spectrum.size())
+                         .arg(elapsed));
+}
+
+void SpectrumPanel::selectRow(const QModelIndex& current) {
+  if (!current.isValid()) return;
+  const ModeSpectrum::Entry& entry =
+      m_model->entry(m_filter->mapToSource(current).row());
+  emit modeSelected(entry.bessel_order_n, entry.root_order_m);
+}
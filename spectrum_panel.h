@@ -0,0 +1,120 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  SpectrumPanel Class.
+  Sorted, filterable table of the modes below a cutoff.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef SPECTRUMPANEL_H
+#define SPECTRUMPANEL_H
+
+#include <QtCore/QAbstractTableModel>
+#include <QtCore/QSortFilterProxyModel>
+#include <QtWidgets/QDoubleSpinBox>
+#include <QtWidgets/QGroupBox>
+#include <QtWidgets/QLabel>
+#include <QtWidgets/QSpinBox>
+#include <QtWidgets/QTableView>
+#include "mode_generator.h"
+#include "mode_spectrum.h"
+#include "solution.h"
+
+// Table of ModeSpectrum entries: n, m, j_nm, frequency and the ratio to
+// f(0, 1). Display text is formatted, Qt::UserRole holds the raw number
+// for sorting.
+class SpectrumModel : public QAbstractTableModel {
+  Q_OBJECT
+
+ public:
+  enum Column { OrderColumn, RootColumn, BesselRootColumn, FrequencyColumn,
+                RatioColumn, ColumnCount };
+
+  explicit SpectrumModel(QObject* parent = 0);
+  void setSpectrum(const QVector<ModeSpectrum::Entry>& spectrum,
+                   double fundamental_frequency);
+  const ModeSpectrum::Entry& entry(int row) const;
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex& index,
+                int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+
+ private:
+  QVector<ModeSpectrum::Entry> m_spectrum;
+  double m_fundamentalFrequency;
+  double m_fundamentalRoot;
+};
+
+// Keeps the rows of one order and/or one root number; -1 keeps all.
+class SpectrumFilter : public QSortFilterProxyModel {
+  Q_OBJECT
+
+ public:
+  explicit SpectrumFilter(QObject* parent = 0);
+
+ public Q_SLOTS:
+  void setOrder(int bessel_order_n);
+  void setRoot(int root_order_m);
+
+ protected:
+  bool filterAcceptsRow(int sourceRow,
+                        const QModelIndex& sourceParent) const override;
+
+ private:
+  int m_order;
+  int m_root;
+};
+
+// Lists every mode below a frequency cutoff, sorted and filterable;
+// selecting a row asks for that mode. The listing runs on the generator.
+class SpectrumPanel : public QGroupBox {
+  Q_OBJECT
+
+ public:
+  const static double defaultCutoffRatio;
+
+  SpectrumPanel(Solution* solution, ModeGenerator* generator,
+                QWidget* parent = 0);
+
+ Q_SIGNALS:
+  void modeSelected(int bessel_order_n, int root_order_m);
+
+ public Q_SLOTS:
+  void listModes();
+
+ private Q_SLOTS:
+  void selectRow(const QModelIndex& current);
+  void showSpectrum(const QVector<ModeSpectrum::Entry>& spectrum,
+                    qint64 elapsed);
+
+ private:
+  Solution* m_solution;
+  ModeGenerator* m_generator;
+  QDoubleSpinBox* m_cutoff;
+  QLabel* m_summary;
+  SpectrumModel* m_model;
+  SpectrumFilter* m_filter;
+  QTableView* m_table;
+};
+
+#endif
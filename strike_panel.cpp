@@ -0,0 +1,140 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  StrikePanel Class.
+  Strike conditions for the superposition view.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "strike_panel.h"
+#include <QtCore/QtMath>
+#include <QtWidgets/QFileDialog>
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QVBoxLayout>
+
+const int StrikePanel::defaultModeCount = 200;
+const int StrikePanel::maxModeCount = 4000;
+
+StrikePanel::StrikePanel(QWidget* parent)
+    : QGroupBox(QStringLiteral("Strike"), parent)
+{
+  m_position = new QDoubleSpinBox(this);
+  m_position->setRange(0.0, 0.99);
+  m_position->setSingleStep(0.05);
+  m_position->setValue(0.5);
+  m_position->setPrefix("Position r/R:    ");
+
+  m_angle = new QDoubleSpinBox(this);
+  m_angle->setRange(0.0, 360.0);
+  m_angle->setDecimals(1);
+  m_angle->setSingleStep(5.0);
+  m_angle->setPrefix("Angle:    ");
+  m_angle->setSuffix(" deg");
+
+  m_width = new QDoubleSpinBox(this);
+  m_width->setRange(0.01, 0.5);
+  m_width->setSingleStep(0.01);
+  m_width->setValue(0.05);
+  m_width->setPrefix("Mallet Width w/R:    ");
+
+  m_modeCount = new QSpinBox(this);
+  m_modeCount->setRange(1, maxModeCount);
+  m_modeCount->setValue(defaultModeCount);
+  m_modeCount->setPrefix("Modes:    ");
+
+  m_excitation = new QComboBox(this);
+  m_excitation->addItem(QStringLiteral("Strike (initial velocity)"));
+  m_excitation->addItem(QStringLiteral("Pluck (initial displacement)"));
+
+  QPushButton* strikeButton = new QPushButton("&Strike", this);
+
+  m_fundamental = new QDoubleSpinBox(this);
+  m_fundamental->setRange(20.0, 2000.0);
+  m_fundamental->setDecimals(1);
+  m_fundamental->setValue(DrumSynth::defaultFundamental);
+  m_fundamental->setPrefix("Pitch f(0, 1):    ");
+  m_fundamental->setSuffix(" Hz");
+
+  m_decayTime = new QDoubleSpinBox(this);
+  m_decayTime->setRange(0.05, 20.0);
+  m_decayTime->setSingleStep(0.1);
+  m_decayTime->setValue(DrumSynth::defaultDecayTime);
+  m_decayTime->setPrefix("Decay Time:    ");
+  m_decayTime->setSuffix(" s");
+
+  m_sound = new QCheckBox(QStringLiteral("Play Sound"), this);
+#ifdef DRUM_AUDIO_OUTPUT
+  m_sound->setChecked(true);
+#else
+  m_sound->setEnabled(false);
+#endif
+  QPushButton* exportButton = new QPushButton("Export &WAV...", this);
+
+  QVBoxLayout* vBox = new QVBoxLayout;
+  vBox->addWidget(m_position);
+  vBox->addWidget(m_angle);
+  vBox->addWidget(m_width);
+  vBox->addWidget(m_modeCount);
+  vBox->addWidget(m_excitation);
+  vBox->addWidget(strikeButton);
+  vBox->addWidget(m_fundamental);
+  vBox->addWidget(m_decayTime);
+  vBox->addWidget(m_sound);
+  vBox->addWidget(exportButton);
+  setLayout(vBox);
+
+  connect(strikeButton, &QPushButton::clicked, this,
+          &StrikePanel::requestStrike);
+  connect(exportButton, &QPushButton::clicked, this,
+          &StrikePanel::exportWavAs);
+}
+
+StrikeCondition StrikePanel::strikeCondition() const {
+  StrikeCondition strike;
+  strike.position = float(m_position->value());
+  strike.angle = float(qDegreesToRadians(m_angle->value()));
+  strike.width = float(m_width->value());
+  strike.excitation = StrikeCondition::Excitation(m_excitation->currentIndex());
+  return strike;
+}
+
+double StrikePanel::fundamental() const {
+  return m_fundamental->value();
+}
+
+double StrikePanel::decayTime() const {
+  return m_decayTime->value();
+}
+
+bool StrikePanel::isSoundEnabled() const {
+  return m_sound->isChecked();
+}
+
+void StrikePanel::requestStrike() {
+  emit strikeRequested(strikeCondition(), m_modeCount->value());
+}
+
+void StrikePanel::exportWavAs() {
+  QString fileName = QFileDialog::getSaveFileName(
+      this, QStringLiteral("Export WAV"), QString(),
+      QStringLiteral("WAV (*.wav)"));
+  if (!fileName.isEmpty()) emit wavExportRequested(fileName);
+}
@@ -0,0 +1,74 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  StrikePanel Class.
+  Strike conditions for the superposition view.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef STRIKEPANEL_H
+#define STRIKEPANEL_H
+
+#include <QtWidgets/QCheckBox>
+#include <QtWidgets/QComboBox>
+#include <QtWidgets/QDoubleSpinBox>
+#include <QtWidgets/QGroupBox>
+#include <QtWidgets/QSpinBox>
+#include "drum_synth.h"
+#include "superposition.h"
+
+// Side panel describing a drum hit: where and how wide the mallet lands,
+// whether it strikes or plucks, and how many of the lowest modes the
+// resulting superposition keeps. The sound of the strike is tuned by the
+// pitch of mode (0, 1) and the decay time of that mode.
+class StrikePanel : public QGroupBox {
+  Q_OBJECT
+
+ public:
+  const static int defaultModeCount;
+  const static int maxModeCount;
+
+  explicit StrikePanel(QWidget* parent = 0);
+  StrikeCondition strikeCondition() const;
+  double fundamental() const;
+  double decayTime() const;
+  bool isSoundEnabled() const;
+
+ Q_SIGNALS:
+  void strikeRequested(const StrikeCondition& strike, int modeCount);
+  void wavExportRequested(const QString& fileName);
+
+ private Q_SLOTS:
+  void requestStrike();
+  void exportWavAs();
+
+ private:
+  QDoubleSpinBox* m_position;
+  QDoubleSpinBox* m_angle;
+  QDoubleSpinBox* m_width;
+  QSpinBox* m_modeCount;
+  QComboBox* m_excitation;
+  QDoubleSpinBox* m_fundamental;
+  QDoubleSpinBox* m_decayTime;
+  QCheckBox* m_sound;
+};
+
+#endif
@@ -0,0 +1,173 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  Superposition Class.
+  Sum of normal modes excited by a drum strike.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#include "superposition.h"
+#include <QtCore/QVarLengthArray>
+#include <algorithm>
+#include <cmath>
+#include "metrics.h"
+
+Superposition::Superposition() {}
+
+Superposition::Superposition(int rowCount, int columnCount,
+                             const QVector<float>& radii,
+                             const QVector<float>& thetas,
+                             const QVector<Mode>& modes,
+                             const QVector<float>& orders,
+                             const QVector<float>& radial,
+                             const QVector<float>& angular)
+    : m_data(new Data) {
+  m_data->rowCount = rowCount;
+  m_data->columnCount = columnCount;
+  m_data->radii = radii;
+  m_data->thetas = thetas;
+  m_data->modes = modes;
+  m_data->radial = radial;
+  m_data->angular = angular;
+  m_data->heights.resize(rowCount * columnCount);
+  int mode = 0;
+  for (float order : orders) {
+    m_data->orderStarts.append(mode);
+    while (mode < modes.size() && modes[mode].bessel_order_n == order) mode++;
+  }
+  m_data->orderStarts.append(mode);
+}
+
+bool Superposition::isEmpty() const {
+  return !m_data || m_data->modes.isEmpty();
+}
+
+int Superposition::modeCount() const {
+  return m_data ? m_data->modes.size() : 0;
+}
+
+int Superposition::rowCount() const {
+  return m_data ? m_data->rowCount : 0;
+}
+
+int Superposition::columnCount() const {
+  return m_data ? m_data->columnCount : 0;
+}
+
+QVector<float> Superposition::radii() const {
+  return m_data ? m_data->radii : QVector<float>();
+}
+
+QVector<float> Superposition::thetas() const {
+  return m_data ? m_data->thetas : QVector<float>();
+}
+
+const Superposition::Mode& Superposition::mode(int index) const {
+  return m_data->modes[index];
+}
+
+QVector<Superposition::Mode> Superposition::modes() const {
+  return m_data ? m_data->modes : QVector<Mode>();
+}
+
+// The temporal factors live on the stack for up to 4096 modes, so frames
+// do not allocate. The inner loops run over contiguous floats and are left
+// to the compiler to vectorize.
+void Superposition::evaluate(double t, float* heights) const {
+  if (isEmpty()) return;
+  const Data& data = *m_data;
+  const int modes = data.modes.size();
+  const int columns = data.columnCount;
+  const int orders = data.orderStarts.size() - 1;
+  QVarLengthArray<float, 4096> temporal(modes);
+  for (int i(0); i < modes; i++) {
+    const Mode& mode = data.modes[i];
+    const double phase = std::fmod(mode.omega * t, 2 * M_PI);
+    temporal[i] = float(mode.cosine * std::cos(phase) +
+                        mode.sine * std::sin(phase));
+  }
+  for (int j(0); j < data.rowCount; j++) {
+    float* row = heights + j * columns;
+    const float* radial = data.radial.constData() + j * modes;
+    std::fill(row, row + columns, 0.0f);
+    for (int o(0); o < orders; o++) {
+      float amplitude = 0.0f;
+      for (int i = data.orderStarts[o]; i < data.orderStarts[o + 1]; i++)
+        amplitude += temporal[i] * radial[i];
+      if (amplitude == 0.0f) continue;
+      const float* angular = data.angular.constData() + o * columns;
+      for (int k(0); k < columns; k++) row[k] += amplitude * angular[k];
+    }
+  }
+}
+
+// Largest |z| over the grid at the given number of instants in [0, duration).
+float Superposition::peakDisplacement(double duration, int instants) const {
+  if (isEmpty()) return 0.0f;
+  float peak = 0.0f;
+  QVector<float> heights(m_data->rowCount * m_data->columnCount);
+  for (int i(0); i < instants; i++) {
+    evaluate(duration * i / instants, heights.data());
+    for (float height : heights) peak = qMax(peak, std::fabs(height));
+  }
+  return peak;
+}
+
+// Scales every coefficient; only meant for freshly built superpositions,
+// it changes all copies.
+void Superposition::scale(float factor) {
+  if (isEmpty()) return;
+  for (Mode& mode : m_data->modes) {
+    mode.cosine *= factor;
+    mode.sine *= factor;
+  }
+}
+
+QSurfaceDataArray* Superposition::newSurfaceDataArray(double t) const {
+  if (isEmpty()) return new QSurfaceDataArray();
+  const Data& data = *m_data;
+  auto newArray = new QSurfaceDataArray();
+  newArray->reserve(data.rowCount);
+  for (int j(0); j < data.rowCount; j++) {
+    QSurfaceDataRow* newRow = new QSurfaceDataRow(data.columnCount);
+    for (int k(0); k < data.columnCount; k++)
+      (*newRow)[k].setPosition(
+          QVector3D(data.thetas[k], 0.0f, data.radii[j]));
+    newArray->append(newRow);
+  }
+  updateSurfaceDataArray(t, *newArray);
+  return newArray;
+}
+
+// Same grid contract as ModeField::updateSurfaceDataArray.
+void Superposition::updateSurfaceDataArray(double t,
+                                           QSurfaceDataArray& array) const {
+  if (isEmpty()) return;
+  MetricsTimer timer(Metrics::SurfaceUpdate);
+  const Data& data = *m_data;
+  float* heights = data.heights.data();
+  evaluate(t, heights);
+  for (int j(0); j < data.rowCount; j++) {
+    QSurfaceDataItem* items = array[j]->data();
+    const float* row = heights + j * data.columnCount;
+    for (int k(0); k < data.columnCount; k++) items[k].setY(row[k]);
+  }
+}
@@ -0,0 +1,112 @@
+/*
+  Normal modes of a vibrating circular membrane (drumhead).
+  Superposition Class.
+  Sum of normal modes excited by a drum strike.
+  Copyright  2017 Spiros Kabasakalis <kabasakalis@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the "Software"),
+  to deal in the Software without restriction, including without limitation
+  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+  and/or sell copies of the Software, and to permit persons to whom the
+  Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included
+  in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+  OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ **/
+
+#ifndef SUPERPOSITION_H
+#define SUPERPOSITION_H
+
+#include <QtCore/QMetaType>
+#include <QtCore/QVector>
+#include <QtDataVisualization/QSurface3DSeries>
+#include <memory>
+
+using namespace QtDataVisualization;
+
+// Initial condition of a drum hit: a Gaussian mallet profile centred at
+// (position, angle), applied as initial velocity (strike) or as initial
+// displacement (pluck). Lengths are fractions of the membrane radius.
+struct StrikeCondition {
+  enum Excitation { Strike, Pluck };
+  float position;
+  float angle;
+  float width;
+  Excitation excitation;
+};
+
+// Sum of K normal modes,
+//   z(r, theta, t) = sum_nm (A_nm cos w_nm t + B_nm sin w_nm t)
+//                    J_n(k_nm r) cos(n (theta - theta0)).
+// Modes are grouped by order n, so a frame is
+//   z = sum_n cos(n (theta - theta0)) [sum_m T_nm(t) J_n(k_nm r)]
+// which costs one dot product per (row, order) and one contiguous
+// multiply-add per (row, order, column): orders x rows x columns work,
+// not K x rows x columns. Radial tables are stored row major across modes
+// and angular tables once per order. Copies share the tables, and the
+// frame buffer of updateSurfaceDataArray, so frames of one superposition
+// are produced on one thread at a time.
+class Superposition {
+ public:
+  struct Mode {
+    float bessel_order_n;
+    int root_order_m;
+    float bessel_root;
+    double omega;
+    float cosine;
+    float sine;
+    // theta0: the mode varies as cos(n (theta - angle)).
+    float angle;
+  };
+
+  Superposition();
+  // radial holds rowCount x modes.size() values, row major; angular holds
+  // columnCount values per entry of orders. Modes must be grouped by order
+  // in the sequence given by orders.
+  Superposition(int rowCount, int columnCount, const QVector<float>& radii,
+                const QVector<float>& thetas, const QVector<Mode>& modes,
+                const QVector<float>& orders, const QVector<float>& radial,
+                const QVector<float>& angular);
+  bool isEmpty() const;
+  int modeCount() const;
+  int rowCount() const;
+  int columnCount() const;
+  QVector<float> radii() const;
+  QVector<float> thetas() const;
+  const Mode& mode(int index) const;
+  QVector<Mode> modes() const;
+  // Heights at time t into rowCount x columnCount floats, row major.
+  void evaluate(double t, float* heights) const;
+  float peakDisplacement(double duration, int instants) const;
+  void scale(float factor);
+  QSurfaceDataArray* newSurfaceDataArray(double t) const;
+  void updateSurfaceDataArray(double t, QSurfaceDataArray& array) const;
+
+ private:
+  struct Data {
+    int rowCount;
+    int columnCount;
+    QVector<float> radii;
+    QVector<float> thetas;
+    QVector<Mode> modes;
+    QVector<int> orderStarts;
+    QVector<float> radial;
+    QVector<float> angular;
+    mutable QVector<float> heights;
+  };
+  std::shared_ptr<Data> m_data;
+};
+
+Q_DECLARE_METATYPE(Superposition)
+
+#endif